@@ -0,0 +1,434 @@
+// Benchmark suite for the single-CPU simulators. Runs FCFS, SJF, SRT, SRT with actual burst
+// times and RR over a fixed matrix of workloads and reports wall time, estimated scheduler events
+// per second, peak RSS and heap allocations for each, as JSON. Given a baseline written by an
+// earlier run it flags every case that got slower or hungrier and exits with status 1.
+// The default matrix stops at 10^4 processes so a run takes minutes; --large adds the 10^5 and
+// 10^6 cases, which take hours because traced ready queues grow with n. The clock-2^31 case runs
+// the clock past 2^31 ms, and every run fails unless its CPU utilization is within (0, 100].
+//
+// Build: gcc -O2 -o bench bench.c -lm -lpthread
+// Usage: ./bench [--output FILE] [--baseline FILE] [--tolerance PCT] [--repeat N] [--max-n N] [--large]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+// Heap allocations made by the simulators, counted by routing their allocator calls through
+// these wrappers. Defined before the simulator headers are included so only their calls are renamed.
+static long long bench_allocations;
+static long long bench_allocated_bytes;
+
+static void* bench_malloc(size_t size) {
+    bench_allocations++;
+    bench_allocated_bytes += (long long)size;
+    return malloc(size);
+}
+
+static void* bench_calloc(size_t count, size_t size) {
+    bench_allocations++;
+    bench_allocated_bytes += (long long)(count * size);
+    return calloc(count, size);
+}
+
+static void* bench_realloc(void *pointer, size_t size) {
+    bench_allocations++;
+    bench_allocated_bytes += (long long)size;
+    return realloc(pointer, size);
+}
+
+static void* bench_aligned_alloc(size_t alignment, size_t size) {
+    bench_allocations++;
+    bench_allocated_bytes += (long long)size;
+    return aligned_alloc(alignment, size);
+}
+
+#define malloc bench_malloc
+#define calloc bench_calloc
+#define realloc bench_realloc
+#define aligned_alloc bench_aligned_alloc
+
+#include "trace.h"
+#include "process.h"
+#include "stats.h"
+#include "context.h"
+#include "workload.h"
+#include "sim_fcfs.h"
+#include "sim_sjf.h"
+#include "sim_srt.h"
+#include "sim_rr.h"
+
+#define BENCH_TCS 4
+#define BENCH_ALPHA 0.75
+#define BENCH_T_SLICE 256
+#define BENCH_DEFAULT_REPEAT 3
+#define BENCH_DEFAULT_TOLERANCE 10.0    // Percent
+#define BENCH_NOISE_MS 0.1              // Wall time differences below this are never regressions
+#define BENCH_NOISE_RSS_KB 1024
+#define BENCH_ALGORITHMS 5
+
+// One workload of the matrix
+typedef struct {
+    const char *name;
+    int n_processes;
+    int n_cpu_processes;
+    int seed;
+    double lambda;
+    int ceiling;
+    int all_at_zero;        // Every process arrives at t=0
+    int large;              // Only run with --large
+} BenchCase;
+
+static const BenchCase bench_cases[] = {
+    { "n10",             10,      2,      1, 0.001,  1024, 0, 0 },
+    { "n100",            100,     20,     1, 0.001,  1024, 0, 0 },
+    { "n1k",             1000,    200,    1, 0.001,  1024, 0, 0 },
+    { "n10k",            10000,   2000,   1, 0.001,  1024, 0, 0 },
+    { "n100k",           100000,  20000,  1, 0.001,  1024, 0, 1 },
+    { "n1m",             1000000, 200000, 1, 0.001,  1024, 0, 1 },
+    { "io-bound-10k",    10000,   0,      2, 0.001,  1024, 0, 0 },
+    { "cpu-bound-10k",   10000,   10000,  2, 0.001,  1024, 0, 0 },
+    { "short-10k",       10000,   2000,   3, 0.01,   256,  0, 0 },
+    { "long-10k",        10000,   2000,   3, 0.0001, 8192, 0, 0 },
+    { "at-zero-1k",      1000,    200,    4, 0.001,  1024, 1, 0 },
+    { "at-zero-10k",     10000,   2000,   4, 0.001,  1024, 1, 0 },
+    { "clock-2^31",      5000,    5000,   1, 0.0001, 100000, 0, 0 },
+};
+#define BENCH_CASES ((int)(sizeof(bench_cases) / sizeof(bench_cases[0])))
+
+static const char *bench_algorithm_names[BENCH_ALGORITHMS] = { "FCFS", "SJF", "SRT", "SRT-actual", "RR" };
+
+// Measurements of one algorithm on one case
+typedef struct {
+    double wall_ms;             // Fastest of the repeats
+    long long estimated_events; // Not counted: arrivals, CPU and I/O burst completions from the workload,
+                                // plus the context switches and preemptions the run reported
+    long long allocations;
+    long long allocated_bytes;
+    long peak_rss_kb;           // Of the process that ran it, workload included
+} BenchResult;
+
+// A result read back from a baseline file
+typedef struct {
+    char name[64];
+    char algorithm[16];
+    BenchResult result;
+} BaselineEntry;
+
+typedef struct {
+    const char *output;
+    const char *baseline;
+    double tolerance;
+    int repeat;
+    int max_n;
+    int large;
+} BenchOptions;
+
+// Benchmark Functions:
+// Prototypes:
+void bench_usage(const char *binary);
+void parse_bench_options(int argc, char *argv[], BenchOptions *options);
+SimStats run_algorithm(const SimContext *ctx, int algorithm);
+BenchResult measure_algorithm(const ProcessSet *set, int algorithm, int repeat);
+int load_baseline(const char *path, BaselineEntry *entries, int capacity);
+int compare_result(const BaselineEntry *baseline, int n_baseline, const char *name, const char *algorithm,
+                   const BenchResult *result, double tolerance);
+
+
+void bench_usage(const char *binary) {
+    fprintf(stderr, "Usage: %s [--output FILE] [--baseline FILE] [--tolerance PCT] [--repeat N] [--max-n N] [--large]\n", binary);
+    exit(EXIT_FAILURE);
+}
+
+
+void parse_bench_options(int argc, char *argv[], BenchOptions *options) {
+    options->output = NULL;
+    options->baseline = NULL;
+    options->tolerance = BENCH_DEFAULT_TOLERANCE;
+    options->repeat = BENCH_DEFAULT_REPEAT;
+    options->max_n = 0;
+    options->large = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--large") == 0) {
+            options->large = 1;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            bench_usage(argv[0]);
+        }
+        const char *value = argv[i + 1];
+        char *end;
+        if (strcmp(argv[i], "--output") == 0) {
+            options->output = value;
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            options->baseline = value;
+        } else if (strcmp(argv[i], "--tolerance") == 0) {
+            options->tolerance = strtod(value, &end);
+            if (end == value || *end != '\0' || options->tolerance < 0) {
+                bench_usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--repeat") == 0) {
+            options->repeat = (int)strtol(value, &end, 10);
+            if (end == value || *end != '\0' || options->repeat <= 0) {
+                bench_usage(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--max-n") == 0) {
+            options->max_n = (int)strtol(value, &end, 10);
+            if (end == value || *end != '\0' || options->max_n <= 0) {
+                bench_usage(argv[0]);
+            }
+        } else {
+            bench_usage(argv[0]);
+        }
+        i++;
+    }
+}
+
+
+SimStats run_algorithm(const SimContext *ctx, int algorithm) {
+    switch (algorithm) {
+    case 0:
+        return simulate_fcfs(ctx, BENCH_TCS);
+    case 1:
+        return simulate_sjf(ctx, BENCH_TCS, BENCH_ALPHA, ctx->set->lambda);
+    case 2:
+        return simulate_srt(ctx, BENCH_TCS, BENCH_ALPHA, ctx->set->lambda);
+    case 3:
+        return simulate_srt_actual(ctx, BENCH_TCS, ctx->set->lambda);
+    default:
+        return simulate_rr(ctx, BENCH_TCS, BENCH_T_SLICE, 0);
+    }
+}
+
+
+static double bench_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+
+// Run one algorithm in a child process, so its peak RSS is its own; the trace is formatted as
+// in a real run and written to /dev/null
+BenchResult measure_algorithm(const ProcessSet *set, int algorithm, int repeat) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        fprintf(stderr, "Unable to create a pipe for a benchmark run\n");
+        exit(EXIT_FAILURE);
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        fprintf(stderr, "Unable to fork a benchmark run\n");
+        exit(EXIT_FAILURE);
+    }
+
+    BenchResult result;
+    memset(&result, 0, sizeof(result));
+    if (child == 0) {
+        close(fds[0]);
+        int null_fd = open("/dev/null", O_WRONLY);
+        static TraceSink sink;
+        for (int r = 0; r < repeat; r++) {
+            trace_init(&sink, null_fd);
+            trace_set_processes(&sink, set->processes);
+            SimContext ctx = { set, &sink, NULL };
+            bench_allocations = bench_allocated_bytes = 0;
+            double start = bench_now_ms();
+            SimStats stats = run_algorithm(&ctx, algorithm);
+            trace_flush(&sink);
+            double elapsed = bench_now_ms() - start;
+            trace_close(&sink);
+            // A clock that wrapped shows up as a negative or impossible utilization
+            if (!(stats.cpu_utilization > 0 && stats.cpu_utilization <= 100)) {
+                fprintf(stderr, "%s: implausible CPU utilization %.3f%%\n", bench_algorithm_names[algorithm], stats.cpu_utilization);
+                _exit(EXIT_FAILURE);
+            }
+            if (r == 0 || elapsed < result.wall_ms) {
+                result.wall_ms = elapsed;
+            }
+            long long arrivals = set->n_processes;
+            long long completions = set->n_bursts + (set->n_bursts - set->n_processes);
+            result.estimated_events = arrivals + completions + stats.total_context_switches + stats.total_preemptions;
+            result.allocations = bench_allocations;
+            result.allocated_bytes = bench_allocated_bytes;
+        }
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == (ssize_t)sizeof(result) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        got != (ssize_t)sizeof(result)) {
+        fprintf(stderr, "Benchmark run of %s failed\n", bench_algorithm_names[algorithm]);
+        exit(EXIT_FAILURE);
+    }
+    result.peak_rss_kb = usage.ru_maxrss;
+    return result;
+}
+
+
+// Value of "key": in a result line, as a number or into text as a string; 0 if absent
+static int json_field(const char *line, const char *key, double *number, char *text, size_t text_size) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char *at = strstr(line, pattern);
+    if (at == NULL) {
+        return 0;
+    }
+    at += strlen(pattern);
+    if (text == NULL) {
+        char *end;
+        *number = strtod(at, &end);
+        return end != at;
+    }
+    if (*at++ != '"') {
+        return 0;
+    }
+    size_t length = strcspn(at, "\"");
+    if (length >= text_size) {
+        return 0;
+    }
+    memcpy(text, at, length);
+    text[length] = '\0';
+    return 1;
+}
+
+
+// Read the results of an earlier run's JSON, one per line as this program writes them
+int load_baseline(const char *path, BaselineEntry *entries, int capacity) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "Unable to open baseline %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    char line[1024];
+    int n = 0;
+    while (n < capacity && fgets(line, sizeof(line), f) != NULL) {
+        BaselineEntry *entry = &entries[n];
+        double wall_ms, allocations, rss;
+        if (json_field(line, "case", NULL, entry->name, sizeof(entry->name)) &&
+            json_field(line, "algorithm", NULL, entry->algorithm, sizeof(entry->algorithm)) &&
+            json_field(line, "wall_ms", &wall_ms, NULL, 0) &&
+            json_field(line, "allocations", &allocations, NULL, 0) &&
+            json_field(line, "peak_rss_kb", &rss, NULL, 0)) {
+            entry->result.wall_ms = wall_ms;
+            entry->result.allocations = (long long)allocations;
+            entry->result.peak_rss_kb = (long)rss;
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+
+// Report how result compares with its baseline entry, if there is one; returns the number of
+// metrics that regressed. Allocation counts are deterministic, so any increase counts.
+int compare_result(const BaselineEntry *baseline, int n_baseline, const char *name, const char *algorithm,
+                   const BenchResult *result, double tolerance) {
+    for (int i = 0; i < n_baseline; i++) {
+        const BaselineEntry *entry = &baseline[i];
+        if (strcmp(entry->name, name) != 0 || strcmp(entry->algorithm, algorithm) != 0) {
+            continue;
+        }
+        const BenchResult *old = &entry->result;
+        double limit = 1 + tolerance / 100;
+        int regressions = 0;
+        if (result->wall_ms > old->wall_ms * limit && result->wall_ms - old->wall_ms > BENCH_NOISE_MS) {
+            fprintf(stderr, "REGRESSION %s %s: wall time %.3f ms -> %.3f ms (%+.1f%%)\n", name, algorithm,
+                    old->wall_ms, result->wall_ms, (result->wall_ms / old->wall_ms - 1) * 100);
+            regressions++;
+        }
+        if (result->allocations > old->allocations) {
+            fprintf(stderr, "REGRESSION %s %s: allocations %lld -> %lld\n", name, algorithm, old->allocations, result->allocations);
+            regressions++;
+        }
+        if (result->peak_rss_kb > old->peak_rss_kb * limit && result->peak_rss_kb - old->peak_rss_kb > BENCH_NOISE_RSS_KB) {
+            fprintf(stderr, "REGRESSION %s %s: peak RSS %ld kB -> %ld kB\n", name, algorithm, old->peak_rss_kb, result->peak_rss_kb);
+            regressions++;
+        }
+        return regressions;
+    }
+    return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    parse_bench_options(argc, argv, &options);
+
+    BaselineEntry *baseline = NULL;
+    int n_baseline = 0;
+    if (options.baseline != NULL) {
+        baseline = (BaselineEntry *)malloc(BENCH_CASES * BENCH_ALGORITHMS * sizeof(BaselineEntry));
+        if (baseline == NULL) {
+            fprintf(stderr, "Memory allocation failed for the baseline\n");
+            exit(EXIT_FAILURE);
+        }
+        n_baseline = load_baseline(options.baseline, baseline, BENCH_CASES * BENCH_ALGORITHMS);
+    }
+    FILE *out = stdout;
+    if (options.output != NULL && (out = fopen(options.output, "w")) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", options.output);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "{\n  \"tcs\": %d, \"alpha\": %.2f, \"t_slice\": %d, \"repeat\": %d,\n  \"results\": [\n",
+            BENCH_TCS, BENCH_ALPHA, BENCH_T_SLICE, options.repeat);
+    fprintf(stderr, "%-16s %-11s %12s %14s %12s %12s\n", "case", "algorithm", "wall ms", "est events/s", "peak RSS kB", "allocations");
+    int regressions = 0;
+    int first = 1;
+    for (int c = 0; c < BENCH_CASES; c++) {
+        const BenchCase *bench = &bench_cases[c];
+        if ((bench->large && !options.large) || (options.max_n > 0 && bench->n_processes > options.max_n)) {
+            continue;
+        }
+
+        ProcessSet set = generate_workload(bench->n_processes, bench->n_cpu_processes, bench->seed,
+                                           bench->lambda, bench->ceiling, 1);
+        if (bench->all_at_zero) {
+            for (int i = 0; i < set.n_processes; i++) {
+                set.processes[i].arrival_time = 0;
+                set.columns.arrival_time[i] = 0;
+            }
+            build_arrival_order(&set);
+        }
+
+        for (int algorithm = 0; algorithm < BENCH_ALGORITHMS; algorithm++) {
+            const char *name = bench_algorithm_names[algorithm];
+            BenchResult result = measure_algorithm(&set, algorithm, options.repeat);
+            double events_per_sec = result.wall_ms > 0 ? result.estimated_events / (result.wall_ms / 1e3) : 0;
+            fprintf(out, "%s    {\"case\": \"%s\", \"algorithm\": \"%s\", \"n\": %d, \"n_cpu\": %d, \"lambda\": %g, "
+                    "\"wall_ms\": %.3f, \"estimated_events\": %lld, \"estimated_events_per_sec\": %.0f, \"peak_rss_kb\": %ld, "
+                    "\"allocations\": %lld, \"allocated_bytes\": %lld}",
+                    first ? "" : ",\n", bench->name, name, bench->n_processes, bench->n_cpu_processes, bench->lambda,
+                    result.wall_ms, result.estimated_events, events_per_sec, result.peak_rss_kb,
+                    result.allocations, result.allocated_bytes);
+            first = 0;
+            fprintf(stderr, "%-16s %-11s %12.3f %14.0f %12ld %12lld\n", bench->name, name, result.wall_ms,
+                    events_per_sec, result.peak_rss_kb, result.allocations);
+            regressions += compare_result(baseline, n_baseline, bench->name, name, &result, options.tolerance);
+        }
+        free_process_set(&set);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(baseline);
+
+    if (options.baseline != NULL) {
+        fprintf(stderr, "%d regression%s against %s\n", regressions, regressions == 1 ? "" : "s", options.baseline);
+    }
+    return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
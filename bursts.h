@@ -0,0 +1,143 @@
+#ifndef BURSTS_H
+#define BURSTS_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "trace.h"
+#include "process.h"
+#include "rand48.h"
+#include "workload.h"
+#include "import.h"
+
+// Where one process stands in its burst sequence on a streaming set
+typedef struct {
+    Rand48 rng;             // Positioned just after the bursts drawn so far
+    long long offset;       // Trace sets: file offset of the next CPU burst to read
+    int index;              // Index of the CPU burst held in cpu; -1 before the first draw
+    int cpu;
+    int io;                 // I/O burst following cpu; unused after the last CPU burst
+    int first;              // CPU burst 0, which SJF without estimates keeps using as its key
+} BurstStream;
+
+// Burst lookups for one simulation run. Materialized sets are read straight out of their burst
+// tables. Streaming sets draw (or read from their trace) each CPU burst and the I/O burst after
+// it when the simulator first asks for it and keep only that pair, so every run needs its own cursor.
+//
+// Streaming removes the burst tables, not the per-process state. Per process, a generated set
+// still holds its Process, arrival order and columns (41 bytes), each live cursor a BurstStream
+// (32 bytes), and each running simulator its Engine arrays (100 bytes), I/O timer slot and ready
+// queue entry; only the bursts are O(1) per process.
+typedef struct {
+    const ProcessSet *set;
+    BurstStream *streams;   // One per process; NULL for materialized sets
+    StatAccumulator *cpu_burst_stats;   // Where streamed bursts are added, indexed by is_cpu_bound; NULL when not collecting
+    StatAccumulator *io_burst_stats;
+} BurstCursor;
+
+// BurstCursor Functions:
+// Prototypes:
+void burst_cursor_init(BurstCursor *cursor, const ProcessSet *set);
+void burst_cursor_free(BurstCursor *cursor);
+void burst_cursor_collect_stats(BurstCursor *cursor, StatAccumulator *cpu_burst_stats, StatAccumulator *io_burst_stats);
+int cpu_burst(BurstCursor *cursor, int pid, int index);
+int io_burst(BurstCursor *cursor, int pid, int index);
+
+
+void burst_cursor_init(BurstCursor *cursor, const ProcessSet *set) {
+    cursor->set = set;
+    cursor->streams = NULL;
+    cursor->cpu_burst_stats = NULL;
+    cursor->io_burst_stats = NULL;
+    if (!set->streaming) {
+        return;
+    }
+
+    cursor->streams = (BurstStream *)malloc(set->n_processes * sizeof(BurstStream));
+    if (cursor->streams == NULL) {
+        fprintf(stderr, "Memory allocation failed for burst streams\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < set->n_processes; i++) {
+        if (set->streaming == BURSTS_TRACE) {
+            cursor->streams[i].offset = set->columns.trace_offset[i];
+        } else {
+            cursor->streams[i].rng = set->columns.burst_rng[i];
+        }
+        cursor->streams[i].index = -1;
+    }
+}
+
+
+void burst_cursor_free(BurstCursor *cursor) {
+    free(cursor->streams);
+    cursor->streams = NULL;
+}
+
+
+// Add every burst this cursor streams to the given statistics. A cursor that walks each burst once,
+// like the process listing, fills in the statistics generation left empty.
+void burst_cursor_collect_stats(BurstCursor *cursor, StatAccumulator *cpu_burst_stats, StatAccumulator *io_burst_stats) {
+    cursor->cpu_burst_stats = cpu_burst_stats;
+    cursor->io_burst_stats = io_burst_stats;
+}
+
+
+// Bring a process's stream up to CPU burst index, drawing in the same order as generate_process.
+// Simulators only ever move forward through a process's bursts, apart from rereading burst 0.
+static BurstStream* burst_stream_at(BurstCursor *cursor, int pid, int index) {
+    const ProcessSet *set = cursor->set;
+    BurstStream *stream = &cursor->streams[pid];
+    int is_cpu_bound = set->columns.is_cpu_bound[pid];
+    if (index < stream->index) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Burst %d of process %d requested after burst %d was streamed\n", index, pid, stream->index);
+        exit(EXIT_FAILURE);
+    }
+    while (stream->index < index) {
+        stream->index++;
+        int with_io = stream->index < set->columns.num_bursts[pid] - 1;
+        if (set->streaming == BURSTS_TRACE) {
+            import_read_burst(set, &stream->offset, with_io, &stream->cpu, &stream->io);
+        } else {
+            stream->cpu = draw_cpu_burst(&stream->rng, set->lambda, set->upper_bound, is_cpu_bound);
+            if (with_io) {
+                stream->io = draw_io_burst(&stream->rng, set->lambda, set->upper_bound, is_cpu_bound);
+            }
+        }
+        if (stream->index == 0) {
+            stream->first = stream->cpu;
+        }
+        if (cursor->cpu_burst_stats != NULL) {
+            stat_add(&cursor->cpu_burst_stats[is_cpu_bound], stream->cpu);
+            if (with_io) {
+                stat_add(&cursor->io_burst_stats[is_cpu_bound], stream->io);
+            }
+        }
+    }
+    return stream;
+}
+
+
+// CPU burst index of process pid
+int cpu_burst(BurstCursor *cursor, int pid, int index) {
+    if (cursor->streams == NULL) {
+        const ProcessSet *set = cursor->set;
+        return set->cpu_bursts[set->columns.burst_offset[pid] + index];
+    }
+    if (index == 0 && cursor->streams[pid].index > 0) {
+        return cursor->streams[pid].first;
+    }
+    return burst_stream_at(cursor, pid, index)->cpu;
+}
+
+
+// I/O burst that follows CPU burst index of process pid
+int io_burst(BurstCursor *cursor, int pid, int index) {
+    if (cursor->streams == NULL) {
+        const ProcessSet *set = cursor->set;
+        return set->io_bursts[set->columns.burst_offset[pid] - pid + index];
+    }
+    return burst_stream_at(cursor, pid, index)->io;
+}
+
+#endif // BURSTS_H
@@ -0,0 +1,16 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "process.h"
+#include "trace.h"
+#include "histogram.h"
+
+// Everything a simulator run reads or writes outside its own locals. Runs sharing a
+// ProcessSet may execute concurrently as long as each has its own trace sink.
+typedef struct {
+    const ProcessSet *set;  // Read-only workload
+    TraceSink *trace;       // Destination for this run's trace lines
+    LatencyHistograms *latency;     // Per-burst latencies are added to these when not NULL
+} SimContext;
+
+#endif // CONTEXT_H
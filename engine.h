@@ -0,0 +1,446 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+#include "profile.h"
+#include "queue.h"
+#include "levels.h"
+#include "rbtree.h"
+#include "tickets.h"
+#include "process.h"
+#include "timer.h"
+#include "event.h"
+#include "bursts.h"
+#include "stats.h"
+#include "context.h"
+
+// The engine loop is forced inline into each policy's simulate function. The policy table is a
+// compile-time constant there, so every hook call folds into a direct call the compiler can inline.
+#define ENGINE_INLINE static inline __attribute__((always_inline))
+
+// Single-CPU simulation parameters; each policy reads the ones it needs
+typedef struct {
+    int tcs;
+    double alpha;
+    double lambda;
+    int t_slice;
+    int rr_alt;
+    int levels;             // Priority levels of a leveled ready queue
+    const int *quanta;      // Time quantum of each level
+    int boost_period;       // Interval between priority boosts; 0 never boosts
+    int target_latency;     // Period in which every runnable process of a fair policy gets a turn
+    int min_granularity;    // Shortest run a fair policy hands out
+    const int *weights;     // Fair-share weight indexed by is_cpu_bound
+    const int *tickets;     // Proportional-share tickets indexed by is_cpu_bound
+    long seed;              // Seed of a randomized policy's draw stream
+} SchedParams;
+
+// How a policy's ready queue is organised
+#define READY_FIFO 0        // Queue in arrival order
+#define READY_LEVELS 1      // LevelQueues, one FIFO per priority level
+#define READY_TREE 2        // ReadyTree ordered by keys from admit
+#define READY_POOL 3        // TicketPool drawn from by lottery
+
+// What happened when the running process reached the end of its scheduled run
+#define RUN_FINISHED 0      // The CPU burst is complete
+#define RUN_CONTINUES 1     // A new slice was started in place; the process keeps the CPU
+#define RUN_PREEMPTED 2     // The process went back to the ready queue
+
+// Simulation state shared by the engine loop and the policy hooks
+typedef struct {
+    const ProcessSet *set;
+    TraceSink *trace;
+    LatencyHistograms *latency; // From the context; NULL records no latencies
+    const SchedParams *params;
+    Process *processes;
+    int n_processes;
+
+    long long current_time;
+    int next_arrival;
+    int finished_processes;
+    int *remaining_bursts;
+    int *burst_index;
+    IoTimers *io_timers;
+    BurstCursor bursts;
+    Queue *queue;               // READY_FIFO ready queue, otherwise NULL
+    LevelQueues *levels;        // READY_LEVELS ready queue, otherwise NULL
+    ReadyTree *tree;            // READY_TREE ready queue, otherwise NULL
+    TicketPool *pool;           // READY_POOL ready queue, otherwise NULL
+
+    Process *cpu_process;       // Running or switching-in process
+    long long cpu_idle_until;   // End of the current context switch
+    long long cpu_burst_end_time; // When the running process reaches the end of its run
+    int delay_pid;              // Dispatch still to be announced (delayed_start policies), or -1
+    long long delay_start_time;
+    int delay_run;
+    Process *preempted_process; // RR_ALT: preempted process that rejoins the front of the queue at the next dispatch
+    int boosts;                 // MLFQ: priority boosts so far
+    long long min_vruntime;     // CFS: monotonic floor of the virtual runtimes in play
+    long long ready_weight;     // CFS: total weight of the queued processes
+    long long global_pass;      // Stride: pass of a client that has received exactly its share
+    long long global_tickets;   // Stride: tickets of every runnable process, running included
+
+    // Per-process state; each policy uses the arrays it needs
+    long long *wait_times;      // Time the current burst has spent in the ready queue so far
+    long long *burst_start;     // When the current burst arrived or came back from I/O
+    long long *last_ready_time; // When the process last joined the ready queue
+    int *responded;             // The current burst has been on the CPU; kept only while recording latencies
+    int *remaining_time;        // Time left in the current burst
+    int *burst_length;          // Length of the current burst
+    int *tau;                   // Burst estimates
+    int *predicted;             // Predicted remaining time of a preempted process
+    int *was_preempted;
+    int *level;                 // Current priority level
+    int *level_used;            // CPU time charged against the current level's quantum
+    int *level_epoch;           // MLFQ: boosts already applied to level and level_used
+    long long *charged_since;   // Start of the running process's uncharged CPU time
+    long long *vruntime;        // Weighted CPU time received (CFS)
+    long long *pass;            // Stride pass value
+    long long *pass_remain;     // Stride: pass left over global_pass when the process last blocked
+
+    // Counters and per-burst statistics indexed by is_cpu_bound, updated as bursts complete
+    StatAccumulator wait[2];
+    StatAccumulator turnaround[2];
+    long long total_burst_time;
+    int total_bursts;
+    int context_switches[2];
+    int preemptions[2];
+    int slice_bursts[2];        // Completed bursts, and those that fit within one time slice
+    int within_slice[2];
+} Engine;
+
+// A scheduling policy: a static const table of hooks passed to run_scheduler.
+// Only run_stopped, announce, init and tick may be NULL.
+typedef struct {
+    const char *name;
+    int ready;              // READY_FIFO, READY_LEVELS, READY_TREE or READY_POOL
+    int delayed_start;      // Trace a dispatch when its context switch ends rather than when it begins
+    void (*init)(Engine *e);
+    // Policy timer, run first in every iteration; returns when it next needs to run, or NO_EVENT
+    long long (*tick)(Engine *e);
+    // Arrival (from_io 0) or I/O completion: queue the process, possibly preempting the running one
+    // through engine_preempt_running
+    void (*admit)(Engine *e, int pid, int from_io);
+    // Slice check when a run ends; without it every run ends with its burst
+    int (*run_stopped)(Engine *e, int pid);
+    // Trace a completed burst and update estimates, before the engine blocks or terminates the process
+    void (*burst_completed)(Engine *e, int pid, int bursts_left);
+    // Dispatch: trace and run bookkeeping, returning how long the process runs
+    int (*start_run)(Engine *e, int pid, long long start_time);
+    void (*announce)(Engine *e, int pid, int run_length);
+    void (*ended)(Engine *e);
+    void (*summarize)(Engine *e, SimStats *stats);
+} SchedPolicy;
+
+// Engine Functions:
+// Prototypes:
+void engine_print_ready(Engine *e);
+int engine_ready_empty(Engine *e);
+void engine_switch_out(Engine *e);
+void engine_preempt_running(Engine *e);
+void engine_summarize(Engine *e, SimStats *stats);
+
+
+void engine_print_ready(Engine *e) {
+    if (e->pool != NULL) {
+        print_pool(e->trace, e->pool);
+    } else if (e->tree != NULL) {
+        print_tree(e->trace, e->tree);
+    } else if (e->levels != NULL) {
+        print_levels(e->trace, e->levels);
+    } else {
+        print_queue(e->trace, e->queue);
+    }
+}
+
+
+int engine_ready_empty(Engine *e) {
+    if (e->pool != NULL) {
+        return pool_is_empty(e->pool);
+    }
+    if (e->tree != NULL) {
+        return tree_is_empty(e->tree);
+    }
+    if (e->levels != NULL) {
+        return levels_is_empty(e->levels);
+    }
+    return is_empty(e->queue);
+}
+
+
+// Take the CPU away from the running process and start the context switch out
+void engine_switch_out(Engine *e) {
+    e->cpu_process = NULL;
+    e->cpu_idle_until = e->current_time + e->params->tcs / 2;
+}
+
+
+// Switch out a running process that has already been put back in the ready queue. Its wait
+// resumes once the switch out is over, as on the multi-CPU path.
+void engine_preempt_running(Engine *e) {
+    int pid = e->cpu_process - e->processes;
+    engine_switch_out(e);
+    e->last_ready_time[pid] = e->cpu_idle_until;
+}
+
+
+// Per-burst wait and turnaround averages from the engine's accumulators, with its counters
+void engine_summarize(Engine *e, SimStats *stats) {
+    StatAccumulator wait = e->wait[0], turnaround = e->turnaround[0];
+    stat_merge(&wait, &e->wait[1]);
+    stat_merge(&turnaround, &e->turnaround[1]);
+
+    stats->cpu_utilization = 100.0 * e->total_burst_time / e->current_time;
+    stats->cpu_bound_wait = stat_mean(&e->wait[1]);
+    stats->io_bound_wait = stat_mean(&e->wait[0]);
+    stats->overall_wait = stat_mean(&wait);
+    stats->cpu_bound_turnaround = stat_mean(&e->turnaround[1]);
+    stats->io_bound_turnaround = stat_mean(&e->turnaround[0]);
+    stats->overall_turnaround = stat_mean(&turnaround);
+    stats->wait_stddev = stat_stddev(&wait);
+    stats->turnaround_stddev = stat_stddev(&turnaround);
+    stats->cpu_bound_context_switches = e->context_switches[1];
+    stats->io_bound_context_switches = e->context_switches[0];
+    stats->total_context_switches = e->context_switches[0] + e->context_switches[1];
+    stats->cpu_bound_preemptions = e->preemptions[1];
+    stats->io_bound_preemptions = e->preemptions[0];
+    stats->total_preemptions = e->preemptions[0] + e->preemptions[1];
+}
+
+
+static void engine_init(Engine *e, const SimContext *ctx, const SchedParams *params, int ready) {
+    const ProcessSet *set = ctx->set;
+    int n = set->n_processes;
+    memset(e, 0, sizeof(*e));
+    e->set = set;
+    e->trace = ctx->trace;
+    e->latency = ctx->latency;
+    e->params = params;
+    e->processes = set->processes;
+    e->n_processes = n;
+
+    // Per-process arrays come from two zeroed blocks, int and 64-bit; arrays a policy never touches cost no memory
+    int *block = (int *)calloc((size_t)n * 11, sizeof(int));
+    if (block == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for simulator state\n");
+        exit(EXIT_FAILURE);
+    }
+    e->remaining_bursts = block;
+    e->burst_index = block + (size_t)n;
+    e->remaining_time = block + (size_t)n * 2;
+    e->burst_length = block + (size_t)n * 3;
+    e->tau = block + (size_t)n * 4;
+    e->predicted = block + (size_t)n * 5;
+    e->was_preempted = block + (size_t)n * 6;
+    e->level = block + (size_t)n * 7;
+    e->level_used = block + (size_t)n * 8;
+    e->responded = block + (size_t)n * 9;
+    e->level_epoch = block + (size_t)n * 10;
+    for (int i = 0; i < n; i++) {
+        e->remaining_bursts[i] = set->processes[i].num_bursts;
+    }
+    long long *wide = (long long *)calloc((size_t)n * 7, sizeof(long long));
+    if (wide == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for simulator state\n");
+        exit(EXIT_FAILURE);
+    }
+    e->vruntime = wide;
+    e->pass = wide + (size_t)n;
+    e->pass_remain = wide + (size_t)n * 2;
+    e->wait_times = wide + (size_t)n * 3;
+    e->burst_start = wide + (size_t)n * 4;
+    e->last_ready_time = wide + (size_t)n * 5;
+    e->charged_since = wide + (size_t)n * 6;
+
+    e->io_timers = create_timers(n);
+    burst_cursor_init(&e->bursts, set);
+    if (ready == READY_POOL) {
+        e->pool = create_ticket_pool(set->processes, n, params->seed);
+    } else if (ready == READY_TREE) {
+        e->tree = create_tree(set->processes, n);
+    } else if (ready == READY_LEVELS) {
+        e->levels = create_levels(params->levels, n);
+    } else {
+        e->queue = create_queue(n);
+    }
+    e->cpu_idle_until = -1;
+    e->cpu_burst_end_time = -1;
+    e->delay_pid = -1;
+    e->delay_start_time = -1;
+}
+
+
+static void engine_free(Engine *e) {
+    free(e->remaining_bursts);
+    free_timers(e->io_timers);
+    burst_cursor_free(&e->bursts);
+    free(e->vruntime);
+    if (e->pool != NULL) {
+        free_ticket_pool(e->pool);
+    } else if (e->tree != NULL) {
+        free_tree(e->tree);
+    } else if (e->levels != NULL) {
+        free_levels(e->levels);
+    } else {
+        free_queue(e->queue);
+    }
+}
+
+
+// Finish the running process's CPU burst, then block it on I/O or terminate it. Its turnaround
+// runs from when the burst became ready to the end of the context switch out.
+ENGINE_INLINE void engine_complete_burst(Engine *e, const SchedPolicy *policy, int pid) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    int bound = process->is_cpu_bound ? 1 : 0;
+    long long turnaround = now + e->params->tcs / 2 - e->burst_start[pid];
+    stat_add(&e->wait[bound], e->wait_times[pid]);
+    stat_add(&e->turnaround[bound], turnaround);
+    if (e->latency != NULL) {
+        hist_record(&e->latency->wait[bound], e->wait_times[pid]);
+        hist_record(&e->latency->turnaround[bound], turnaround);
+        e->responded[pid] = 0;
+    }
+    e->wait_times[pid] = 0;
+    e->remaining_bursts[pid]--;
+    int bursts_left = e->remaining_bursts[pid];
+    e->total_burst_time += cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    e->total_bursts++;
+
+    policy->burst_completed(e, pid, bursts_left);
+
+    if (bursts_left > 0) {
+        long long io_done = now + e->params->tcs / 2 + io_burst(&e->bursts, pid, e->burst_index[pid]);
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Process %P switching out of CPU; blocking on I/O until time %lldms ", now, process, io_done);
+            engine_print_ready(e);
+        }
+        timer_add(e->io_timers, pid, io_done);
+        e->burst_index[pid]++;
+    } else {
+        trace_printf(e->trace, "time %lldms: Process %P terminated ", now, process);
+        engine_print_ready(e);
+        e->finished_processes++;
+    }
+}
+
+
+// Take the next process to dispatch off the policy's ready queue
+ENGINE_INLINE Process* engine_pop_ready(Engine *e, const SchedPolicy *policy) {
+    switch (policy->ready) {
+    case READY_POOL:
+        return pool_pop(e->pool);
+    case READY_TREE:
+        return tree_pop_min(e->tree);
+    case READY_LEVELS:
+        return levels_pop(e->levels);
+    default:
+        return dequeue(e->queue);
+    }
+}
+
+
+// Event loop shared by every single-CPU policy. Each iteration handles, in order: the policy timer, arrivals,
+// I/O completions, the end of the current run, a dispatch, and a delayed dispatch announcement,
+// then jumps the clock to the next time any of them can happen.
+ENGINE_INLINE SimStats run_scheduler(const SimContext *ctx, const SchedParams *params, const SchedPolicy *policy) {
+    Engine engine;
+    Engine *e = &engine;
+    engine_init(e, ctx, params, policy->ready);
+    if (policy->init != NULL) {
+        policy->init(e);
+    }
+    const ProcessSet *set = e->set;
+
+    trace_printf(e->trace, "time 0ms: Simulator started for %s [Q empty]\n", policy->name);
+
+    while (e->finished_processes < e->n_processes) {
+        PROFILE_LOOP_BEGIN();
+        long long next_tick = (policy->tick != NULL) ? policy->tick(e) : NO_EVENT;
+
+        while (arrival_due(set, e->next_arrival, e->current_time)) {
+            int pid = set->arrival_order[e->next_arrival++];
+            PROFILE_COUNT(events);
+            e->burst_start[pid] = e->last_ready_time[pid] = e->current_time;
+            policy->admit(e, pid, 0);
+        }
+
+        while (timer_due(e->io_timers, e->current_time)) {
+            int pid = timer_pop(e->io_timers);
+            PROFILE_COUNT(events);
+            e->burst_start[pid] = e->last_ready_time[pid] = e->current_time;
+            policy->admit(e, pid, 1);
+        }
+
+        if (e->cpu_process != NULL && e->current_time == e->cpu_burst_end_time) {
+            int pid = e->cpu_process - e->processes;
+            PROFILE_COUNT(events);
+            int outcome = (policy->run_stopped != NULL) ? policy->run_stopped(e, pid) : RUN_FINISHED;
+            if (outcome == RUN_FINISHED) {
+                engine_complete_burst(e, policy, pid);
+                engine_switch_out(e);
+            } else if (outcome == RUN_PREEMPTED) {
+                engine_preempt_running(e);
+            }
+        }
+
+        if (e->cpu_process == NULL && !engine_ready_empty(e) && e->current_time >= e->cpu_idle_until &&
+            (!policy->delayed_start || e->delay_pid == -1)) {
+            Process *process = engine_pop_ready(e, policy);
+            int pid = process - e->processes;
+            PROFILE_COUNT(events);
+            long long start_time = e->current_time + params->tcs / 2;
+            e->cpu_process = process;
+            e->wait_times[pid] += e->current_time - e->last_ready_time[pid];
+            if (e->latency != NULL && !e->responded[pid]) {
+                e->responded[pid] = 1;
+                hist_record(&e->latency->response[process->is_cpu_bound ? 1 : 0], start_time - e->burst_start[pid]);
+            }
+            int run_length = policy->start_run(e, pid, start_time);
+            e->cpu_burst_end_time = start_time + run_length;
+            e->cpu_idle_until = start_time;
+            e->context_switches[process->is_cpu_bound ? 1 : 0]++;
+            if (policy->delayed_start) {
+                e->delay_pid = pid;
+                e->delay_start_time = start_time;
+                e->delay_run = run_length;
+            }
+        }
+
+        if (policy->delayed_start && e->cpu_process != NULL && e->current_time == e->delay_start_time) {
+            PROFILE_COUNT(events);
+            policy->announce(e, e->delay_pid, e->delay_run);
+            e->delay_pid = -1;
+            e->delay_start_time = -1;
+        }
+
+        // Jump to the next arrival, I/O completion, run end, delayed announcement, context switch boundary or policy timer
+        long long next_time = next_process_event(set, e->next_arrival, e->io_timers, e->current_time);
+        next_time = earliest_event(e->current_time, next_tick, next_time);
+        if (e->cpu_process != NULL) {
+            next_time = earliest_event(e->current_time, e->cpu_burst_end_time, next_time);
+            if (policy->delayed_start) {
+                next_time = earliest_event(e->current_time, e->delay_start_time, next_time);
+            }
+        } else if (!engine_ready_empty(e)) {
+            next_time = earliest_event(e->current_time, e->cpu_idle_until, next_time);
+        }
+        e->current_time = advance_clock(e->current_time, next_time, e->finished_processes == e->n_processes);
+        PROFILE_LOOP_END();
+    }
+
+    policy->ended(e);
+    trace_flush(e->trace);
+
+    SimStats stats = { .algorithm = policy->name };
+    policy->summarize(e, &stats);
+    engine_free(e);
+    return stats;
+}
+
+#endif // ENGINE_H
@@ -0,0 +1,44 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <limits.h>
+#include "profile.h"
+#include "process.h"
+#include "timer.h"
+
+// Sentinel for "nothing left to happen". The clock and every absolute time are long long, so
+// long runs with slow arrivals can go past 2^31 ms.
+#define NO_EVENT LLONG_MAX
+
+// Keep the earlier of best and candidate, ignoring anything not strictly after now
+long long earliest_event(long long now, long long candidate, long long best) {
+    return (candidate > now && candidate < best) ? candidate : best;
+}
+
+// Check if the next process in the arrival schedule arrives exactly at now
+int arrival_due(const ProcessSet *set, int next_arrival, long long now) {
+    PROFILE_COUNT(arrival_scans);
+    return next_arrival < set->n_processes &&
+           set->columns.arrival_time[set->arrival_order[next_arrival]] == now;
+}
+
+// Earliest arrival or I/O completion scheduled strictly after now
+long long next_process_event(const ProcessSet *set, int next_arrival, IoTimers *io_timers, long long now) {
+    long long next_time = earliest_event(now, timer_next(io_timers), NO_EVENT);
+    if (next_arrival < set->n_processes) {
+        next_time = earliest_event(now, set->columns.arrival_time[set->arrival_order[next_arrival]], next_time);
+    }
+    return next_time;
+}
+
+// Move the simulation clock to the next event instead of ticking one millisecond at a time.
+// Once every process has finished the clock still advances by one, matching the old tick loop
+// so the end-of-simulation timestamp and CPU utilization are unchanged.
+long long advance_clock(long long now, long long next_time, int finished) {
+    if (finished || next_time == NO_EVENT) {
+        return now + 1;
+    }
+    return next_time;
+}
+
+#endif // EVENT_H
@@ -0,0 +1,189 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "trace.h"
+#include "profile.h"
+#include "process.h"
+
+// Baseline for queue_bench.c only: no simulator includes this header. SJF, SRT and stride queued
+// on this heap before they moved to ReadyTree (rbtree.h), which prints in order without sorting.
+
+// Heap entry ordered by (key, tau, order)
+typedef struct {
+    Process *process;
+    long long key;          // Primary key, e.g. remaining time
+    int tau;                // Secondary key: current tau estimate
+    int order;              // Final tie-break: process id or insertion sequence
+} HeapEntry;
+
+// Indexed binary min-heap; printing sorts a copy of the entries
+typedef struct {
+    HeapEntry *entries;     // Heap-ordered entries
+    HeapEntry *scratch;     // Scratch copy used to print the queue in order
+    int *position;          // Slot of each process in entries, -1 when not queued
+    Process *base;          // Process array the heap indexes into
+    int size;               // Current size of the heap
+    int capacity;           // Maximum number of queued processes
+    int sequence;           // Insertion counter for FIFO tie-breaks
+} ReadyHeap;
+
+// Heap Functions:
+// Prototypes:
+ReadyHeap* create_heap(Process *base, int capacity);
+void heap_push(ReadyHeap *heap, Process *process, long long key, int tau, int order);
+Process* heap_pop(ReadyHeap *heap);
+bool heap_is_empty(ReadyHeap *heap);
+void print_heap(TraceSink *sink, ReadyHeap *heap);
+void free_heap(ReadyHeap *heap);
+
+// Initialize a heap able to hold every process in base[0..capacity)
+ReadyHeap* create_heap(Process *base, int capacity) {
+    ReadyHeap *heap = (ReadyHeap*)malloc(sizeof(ReadyHeap));
+    if (heap == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for heap\n");
+        exit(EXIT_FAILURE);
+    }
+    heap->entries = (HeapEntry*)malloc(capacity * sizeof(HeapEntry));
+    heap->scratch = (HeapEntry*)malloc(capacity * sizeof(HeapEntry));
+    heap->position = (int*)malloc(capacity * sizeof(int));
+    if (heap->entries == NULL || heap->scratch == NULL || heap->position == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for heap storage\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacity; i++) {
+        heap->position[i] = -1;
+    }
+    heap->base = base;
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->sequence = 0;
+    return heap;
+}
+
+// Strict (key, tau, order) comparison
+static int heap_entry_before(const HeapEntry *a, const HeapEntry *b) {
+    PROFILE_COUNT(queue_compares);
+    if (a->key != b->key) {
+        return a->key < b->key;
+    }
+    if (a->tau != b->tau) {
+        return a->tau < b->tau;
+    }
+    return a->order < b->order;
+}
+
+// Place entry at slot i and record its position
+static void heap_place(ReadyHeap *heap, int i, HeapEntry entry) {
+    heap->entries[i] = entry;
+    heap->position[entry.process - heap->base] = i;
+}
+
+static void heap_sift_up(ReadyHeap *heap, int i) {
+    HeapEntry entry = heap->entries[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_entry_before(&entry, &heap->entries[parent])) {
+            break;
+        }
+        heap_place(heap, i, heap->entries[parent]);
+        i = parent;
+    }
+    heap_place(heap, i, entry);
+}
+
+static void heap_sift_down(ReadyHeap *heap, int i) {
+    HeapEntry entry = heap->entries[i];
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size && heap_entry_before(&heap->entries[child + 1], &heap->entries[child])) {
+            child++;
+        }
+        if (!heap_entry_before(&heap->entries[child], &entry)) {
+            break;
+        }
+        heap_place(heap, i, heap->entries[child]);
+        i = child;
+    }
+    heap_place(heap, i, entry);
+}
+
+// Add a Process to the heap with the given keys
+void heap_push(ReadyHeap *heap, Process *process, long long key, int tau, int order) {
+    int pid = process - heap->base;
+    if (heap->position[pid] != -1 || heap->size == heap->capacity) {
+        trace_flush(&trace_stdout);
+        char id[PROCESS_NAME_MAX];
+        format_process_id(process->id, id);
+        fprintf(stderr, "Process %s is already queued or heap is full\n", id);
+        exit(EXIT_FAILURE);
+    }
+    HeapEntry entry = { process, key, tau, order };
+    PROFILE_COUNT(queue_inserts);
+    heap->entries[heap->size] = entry;
+    heap->size++;
+    heap_sift_up(heap, heap->size - 1);
+}
+
+// Remove and return the Process with the smallest keys
+Process* heap_pop(ReadyHeap *heap) {
+    if (heap_is_empty(heap)) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Heap is empty, cannot pop\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Process *process = heap->entries[0].process;
+    heap->position[process - heap->base] = -1;
+    heap->size--;
+    if (heap->size > 0) {
+        heap->entries[0] = heap->entries[heap->size];
+        heap_sift_down(heap, 0);
+    }
+    return process;
+}
+
+// Check if the heap is empty
+bool heap_is_empty(ReadyHeap *heap) {
+    return heap->size == 0;
+}
+
+static int heap_entry_compare(const void *a, const void *b) {
+    const HeapEntry *x = (const HeapEntry*)a;
+    const HeapEntry *y = (const HeapEntry*)b;
+    return heap_entry_before(x, y) ? -1 : (heap_entry_before(y, x) ? 1 : 0);
+}
+
+// Print the queued processes in the order they would be popped
+void print_heap(TraceSink *sink, ReadyHeap *heap) {
+    if (sink->discard) {
+        return;
+    }
+    for (int i = 0; i < heap->size; i++) {
+        heap->scratch[i] = heap->entries[i];
+    }
+    qsort(heap->scratch, heap->size, sizeof(HeapEntry), heap_entry_compare);
+
+    trace_queue_begin(sink);
+    for (int i = 0; i < heap->size; i++) {
+        trace_queue_item(sink, heap->scratch[i].process);
+    }
+    trace_queue_end(sink);
+}
+
+// Free the heap and its storage
+void free_heap(ReadyHeap *heap) {
+    free(heap->entries);
+    free(heap->scratch);
+    free(heap->position);
+    free(heap);
+}
+
+#endif // HEAP_H
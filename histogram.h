@@ -0,0 +1,239 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+// Log-linear latency histogram in the style of HdrHistogram. Values below HIST_SUB_BUCKETS get a
+// bucket each; above that every power of two is split into HIST_SUB_BUCKETS / 2 equal buckets,
+// so a bucket is never wider than 1/64 of the values in it. Memory is fixed whatever is recorded,
+// recording is a bit scan and an increment, and two histograms merge by adding their counts.
+#define HIST_SUB_BITS 7
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_HALF_BUCKETS (HIST_SUB_BUCKETS / 2)
+#define HIST_BUCKETS (HIST_HALF_BUCKETS * (32 - HIST_SUB_BITS + 1))   // Covers 0..INT_MAX
+
+#define LATENCY_MAX_PERCENTILES 16
+#define LATENCY_METRICS 3
+
+typedef struct {
+    long long counts[HIST_BUCKETS];
+    long long total;
+    int max;                // Largest value recorded, so no percentile is reported above it
+} LatencyHistogram;
+
+// Per-burst latencies of one simulator run, indexed by is_cpu_bound
+typedef struct {
+    LatencyHistogram wait[2];           // Time in the ready queue
+    LatencyHistogram turnaround[2];     // Ready to the end of the switch out
+    LatencyHistogram response[2];       // Ready to the first time on the CPU
+} LatencyHistograms;
+
+// Latency report settings from the command line
+typedef struct {
+    int report;             // Append percentile lines (simout.txt) or columns (sweep table)
+    int n_percentiles;
+    double percentiles[LATENCY_MAX_PERCENTILES];
+    const char *dump;       // Histogram dump path, or NULL
+} LatencyConfig;
+
+static const char *latency_metric_names[LATENCY_METRICS] = { "wait", "turnaround", "response" };
+
+// Histogram Functions:
+// Prototypes:
+void hist_record(LatencyHistogram *hist, long long value);
+void hist_merge(LatencyHistogram *hist, const LatencyHistogram *other);
+int hist_value_at_percentile(const LatencyHistogram *hist, double percentile);
+void hist_write(FILE *f, const LatencyHistogram *hist);
+const LatencyHistogram* latency_metric(const LatencyHistograms *latency, int metric, int bound);
+void latency_merge(LatencyHistograms *latency, const LatencyHistograms *other);
+void latency_overall(const LatencyHistograms *latency, int metric, LatencyHistogram *overall);
+void latency_default_config(LatencyConfig *config);
+int parse_latency_flag(int argc, char *argv[], int *i, LatencyConfig *config);
+void write_latency_percentiles(FILE *f, const LatencyHistograms *latency, const LatencyConfig *config);
+void write_latency_dump(FILE *f, const char *algorithm, const LatencyHistograms *latency);
+
+
+static int hist_index(int value) {
+    if (value < HIST_SUB_BUCKETS) {
+        return value;
+    }
+    // Shift the value down until it has HIST_SUB_BITS significant bits
+    int shift = (31 - __builtin_clz((unsigned)value)) - (HIST_SUB_BITS - 1);
+    return shift * HIST_HALF_BUCKETS + (value >> shift);
+}
+
+// Smallest and largest values that land in bucket index
+static void hist_bucket_range(int index, long long *low, long long *high) {
+    if (index < HIST_SUB_BUCKETS) {
+        *low = *high = index;
+        return;
+    }
+    int shift = index / HIST_HALF_BUCKETS - 1;
+    long long sub = index - (long long)shift * HIST_HALF_BUCKETS;
+    *low = sub << shift;
+    *high = ((sub + 1) << shift) - 1;
+}
+
+// Record one value in ms; negative values count as 0 and values past INT_MAX as INT_MAX
+void hist_record(LatencyHistogram *hist, long long value) {
+    int v = value < 0 ? 0 : (value > INT_MAX ? INT_MAX : (int)value);
+    hist->counts[hist_index(v)]++;
+    hist->total++;
+    if (v > hist->max) {
+        hist->max = v;
+    }
+}
+
+void hist_merge(LatencyHistogram *hist, const LatencyHistogram *other) {
+    if (other->total == 0) {
+        return;
+    }
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        hist->counts[i] += other->counts[i];
+    }
+    hist->total += other->total;
+    if (other->max > hist->max) {
+        hist->max = other->max;
+    }
+}
+
+// Value at or below which percentile% of the samples fall, to bucket precision: the top of the
+// bucket holding that sample, capped at the largest value recorded. 0 when empty.
+int hist_value_at_percentile(const LatencyHistogram *hist, double percentile) {
+    if (hist->total == 0) {
+        return 0;
+    }
+    long long rank = (long long)ceil(percentile / 100.0 * hist->total);
+    if (rank < 1) {
+        rank = 1;
+    }
+    long long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            long long low, high;
+            hist_bucket_range(i, &low, &high);
+            return high < hist->max ? (int)high : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+// Non-empty buckets as "low high count" lines, after a "count N max M" line. Dumps of the same
+// metric merge by adding the counts of equal buckets and taking the larger max.
+void hist_write(FILE *f, const LatencyHistogram *hist) {
+    fprintf(f, "count %lld max %d\n", hist->total, hist->max);
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        if (hist->counts[i] != 0) {
+            long long low, high;
+            hist_bucket_range(i, &low, &high);
+            fprintf(f, "%lld %lld %lld\n", low, high, hist->counts[i]);
+        }
+    }
+}
+
+
+// Histogram of metric (an index into latency_metric_names) for one class
+const LatencyHistogram* latency_metric(const LatencyHistograms *latency, int metric, int bound) {
+    if (metric == 0) {
+        return &latency->wait[bound];
+    }
+    return (metric == 1) ? &latency->turnaround[bound] : &latency->response[bound];
+}
+
+void latency_merge(LatencyHistograms *latency, const LatencyHistograms *other) {
+    for (int bound = 0; bound < 2; bound++) {
+        hist_merge(&latency->wait[bound], &other->wait[bound]);
+        hist_merge(&latency->turnaround[bound], &other->turnaround[bound]);
+        hist_merge(&latency->response[bound], &other->response[bound]);
+    }
+}
+
+// Both classes of one metric combined into overall
+void latency_overall(const LatencyHistograms *latency, int metric, LatencyHistogram *overall) {
+    *overall = *latency_metric(latency, metric, 0);
+    hist_merge(overall, latency_metric(latency, metric, 1));
+}
+
+
+void latency_default_config(LatencyConfig *config) {
+    static const double defaults[] = { 50, 90, 99, 99.9 };
+    config->report = 0;
+    config->n_percentiles = (int)(sizeof(defaults) / sizeof(defaults[0]));
+    memcpy(config->percentiles, defaults, sizeof(defaults));
+    config->dump = NULL;
+}
+
+
+// Parse the latency flag at argv[*i], if it is one, advancing *i past its value. Returns 1 when
+// the flag was consumed, 0 when argv[*i] is not a latency flag, and -1 when its value is invalid.
+// --latency reports the default percentiles, --percentiles picks others and also turns the report on.
+int parse_latency_flag(int argc, char *argv[], int *i, LatencyConfig *config) {
+    const char *flag = argv[*i];
+    if (strcmp(flag, "--latency") == 0) {
+        config->report = 1;
+        return 1;
+    }
+    if (strcmp(flag, "--percentiles") != 0 && strcmp(flag, "--histograms") != 0) {
+        return 0;
+    }
+    if (*i + 1 >= argc) {
+        return -1;
+    }
+    const char *value = argv[++*i];
+    if (strcmp(flag, "--histograms") == 0) {
+        config->dump = value;
+        return 1;
+    }
+
+    // Comma-separated, each in (0, 100]
+    char *end;
+    config->report = 1;
+    config->n_percentiles = 0;
+    do {
+        double percentile = strtod(value, &end);
+        if (end == value || !(percentile > 0 && percentile <= 100) || config->n_percentiles == LATENCY_MAX_PERCENTILES) {
+            return -1;
+        }
+        config->percentiles[config->n_percentiles++] = percentile;
+        value = end + 1;
+    } while (*end == ',');
+    return *end == '\0' ? 1 : -1;
+}
+
+
+// One line per class and metric under an algorithm's simout.txt block
+void write_latency_percentiles(FILE *f, const LatencyHistograms *latency, const LatencyConfig *config) {
+    static const char *classes[3] = { "CPU-bound", "I/O-bound", "overall" };
+    for (int metric = 0; metric < LATENCY_METRICS; metric++) {
+        LatencyHistogram overall;
+        latency_overall(latency, metric, &overall);
+        // CPU-bound, I/O-bound, then both, as in the averages above
+        for (int c = 0; c < 3; c++) {
+            const LatencyHistogram *hist = (c == 2) ? &overall : latency_metric(latency, metric, 1 - c);
+            fprintf(f, "-- %s %s time percentiles:", classes[c], latency_metric_names[metric]);
+            for (int p = 0; p < config->n_percentiles; p++) {
+                fprintf(f, "%s p%g %d ms", p ? "," : "", config->percentiles[p], hist_value_at_percentile(hist, config->percentiles[p]));
+            }
+            fprintf(f, "\n");
+        }
+    }
+    fprintf(f, "\n");
+}
+
+
+// Every histogram of one run, each under a "histogram ALGORITHM METRIC CLASS" line
+void write_latency_dump(FILE *f, const char *algorithm, const LatencyHistograms *latency) {
+    for (int metric = 0; metric < LATENCY_METRICS; metric++) {
+        for (int bound = 1; bound >= 0; bound--) {
+            fprintf(f, "histogram %s %s %s\n", algorithm, latency_metric_names[metric], bound ? "cpu-bound" : "io-bound");
+            hist_write(f, latency_metric(latency, metric, bound));
+        }
+    }
+}
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,398 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trace.h"
+#include "process.h"
+#include "stats.h"
+
+// Captured CPU/I/O burst traces, imported in place of a generated workload. Two formats:
+//
+//   CSV: one process per line, "arrival,cpu_bound,cpu,io,cpu,...,cpu" in ms with cpu_bound 0 or
+//   1, so a process with n CPU bursts has 2n - 1 burst fields. Blank lines and lines starting
+//   with '#' are skipped. Processes are named in file order.
+//
+//   Binary: the 8 bytes "CPUSIMTR", a uint32 version and the uint32 0x01020304 in the writer's
+//   byte order, then per process the int32s arrival, cpu_bound and n followed by the 2n - 1
+//   bursts in the same order as the CSV fields.
+//
+// The file is read sequentially in fixed-size chunks, twice: once to count and validate, then
+// again to fill in a set sized from the count. A streaming import keeps only each process's
+// file offset and reads bursts back with pread as the simulators reach them, so memory stays
+// proportional to the number of processes however many bursts the trace holds.
+#define IMPORT_MAGIC "CPUSIMTR"
+#define IMPORT_VERSION 1
+#define IMPORT_BYTE_ORDER 0x01020304u
+#define IMPORT_HEADER_BYTES 16
+#define IMPORT_CHUNK (1 << 20)
+#define IMPORT_DIGITS_MAX 10        // Longest CSV number accepted, enough for any int
+#define IMPORT_FIELD_MAX 24         // Bytes buffered ahead of each CSV field, more than a number and its separator
+
+// Sequential reader over one trace file
+typedef struct {
+    const char *path;
+    int fd;
+    int binary;
+    unsigned char *buffer;      // IMPORT_CHUNK bytes
+    size_t pos;
+    size_t len;
+    long long base;             // File offset of buffer[0]
+    int eof;
+    long long line;             // CSV: line of the record being read, for errors
+    int more;                   // More burst fields follow in the current record
+    long long values_left;      // Binary: burst fields left in the current record
+} TraceReader;
+
+// Import Functions:
+// Prototypes:
+ProcessSet import_workload(const char *path, int streaming, int *n_cpu_processes);
+void import_read_burst(const ProcessSet *set, long long *offset, int with_io, int *cpu, int *io);
+
+
+static void import_error(const TraceReader *r, const char *reason) {
+    trace_flush(&trace_stdout);
+    if (r->binary) {
+        fprintf(stderr, "Trace file %s at byte %lld: %s\n", r->path, r->base + (long long)r->pos, reason);
+    } else {
+        fprintf(stderr, "Trace file %s line %lld: %s\n", r->path, r->line, reason);
+    }
+    exit(EXIT_FAILURE);
+}
+
+
+// Make at least need unread bytes available unless the file ends first; returns whether it could
+static int import_fill(TraceReader *r, size_t need) {
+    if (r->len - r->pos >= need) {
+        return 1;
+    }
+    memmove(r->buffer, r->buffer + r->pos, r->len - r->pos);
+    r->base += (long long)r->pos;
+    r->len -= r->pos;
+    r->pos = 0;
+    while (r->len < need && !r->eof) {
+        ssize_t got = read(r->fd, r->buffer + r->len, IMPORT_CHUNK - r->len);
+        if (got < 0) {
+            import_error(r, "read failed");
+        }
+        r->eof = (got == 0);
+        r->len += (size_t)got;
+    }
+    return r->len >= need;
+}
+
+
+// Rewind to the first record
+static void import_rewind(TraceReader *r) {
+    long long start = r->binary ? IMPORT_HEADER_BYTES : 0;
+    if (lseek(r->fd, start, SEEK_SET) != start) {
+        import_error(r, "seek failed");
+    }
+    r->pos = r->len = 0;
+    r->base = start;
+    r->eof = 0;
+    r->line = 1;
+}
+
+
+// Parse an unsigned decimal int starting at text; returns the number of digits, or 0 if there
+// are none or the value does not fit
+static int import_parse_int(const unsigned char *text, size_t available, int *value) {
+    long long parsed = 0;
+    size_t digits = 0;
+    while (digits < available && text[digits] >= '0' && text[digits] <= '9') {
+        parsed = parsed * 10 + (text[digits++] - '0');
+        if (parsed > INT_MAX || digits > IMPORT_DIGITS_MAX) {
+            return 0;
+        }
+    }
+    *value = (int)parsed;
+    return (int)digits;
+}
+
+
+// CSV field and the separator after it. Sets r->more when another field of the record follows.
+static int import_csv_field(TraceReader *r) {
+    import_fill(r, IMPORT_FIELD_MAX);
+    int value;
+    int digits = import_parse_int(r->buffer + r->pos, r->len - r->pos, &value);
+    if (digits == 0) {
+        import_error(r, "expected a non-negative integer that fits in an int");
+    }
+    r->pos += digits;
+    if (r->pos == r->len) {
+        r->more = 0;                // Last line without a newline
+    } else if (r->buffer[r->pos] == ',') {
+        r->pos++;
+        r->more = 1;
+    } else if (r->buffer[r->pos] == '\n' || (r->buffer[r->pos] == '\r' && r->pos + 1 < r->len && r->buffer[r->pos + 1] == '\n')) {
+        r->pos += (r->buffer[r->pos] == '\r') ? 2 : 1;
+        r->more = 0;
+    } else {
+        import_error(r, "expected ',' or the end of the line");
+    }
+    return value;
+}
+
+
+static int import_binary_int(TraceReader *r) {
+    if (!import_fill(r, sizeof(int32_t))) {
+        import_error(r, "truncated record");
+    }
+    int32_t value;
+    memcpy(&value, r->buffer + r->pos, sizeof(value));
+    r->pos += sizeof(value);
+    return value;
+}
+
+
+// Start the next record, reading its arrival time and class; returns 0 at the end of the file
+static int import_begin_record(TraceReader *r, int *arrival, int *is_cpu_bound) {
+    if (r->binary) {
+        if (!import_fill(r, 1)) {
+            return 0;
+        }
+        *arrival = import_binary_int(r);
+        *is_cpu_bound = import_binary_int(r);
+        int num_bursts = import_binary_int(r);
+        if (num_bursts < 1) {
+            import_error(r, "a process needs at least one CPU burst");
+        }
+        r->values_left = 2LL * num_bursts - 1;
+    } else {
+        // Skip blank and comment lines
+        while (1) {
+            if (!import_fill(r, 1)) {
+                return 0;
+            }
+            unsigned char c = r->buffer[r->pos];
+            if (c != '\n' && c != '\r' && c != '#') {
+                break;
+            }
+            while (r->buffer[r->pos] != '\n') {
+                r->pos++;
+                if (!import_fill(r, 1)) {
+                    return 0;
+                }
+            }
+            r->pos++;
+            r->line++;
+        }
+        *arrival = import_csv_field(r);
+        if (!r->more) {
+            import_error(r, "missing the CPU-bound flag");
+        }
+        *is_cpu_bound = import_csv_field(r);
+        if (!r->more) {
+            import_error(r, "a process needs at least one CPU burst");
+        }
+    }
+    if (*arrival < 0 || (*is_cpu_bound != 0 && *is_cpu_bound != 1)) {
+        import_error(r, "arrival time must be non-negative and the CPU-bound flag 0 or 1");
+    }
+    return 1;
+}
+
+
+// Next burst field of the current record; returns 0 once the record has none left
+static int import_next_burst(TraceReader *r, int *value) {
+    if (r->binary) {
+        if (r->values_left == 0) {
+            return 0;
+        }
+        r->values_left--;
+        *value = import_binary_int(r);
+        return 1;
+    }
+    if (!r->more) {
+        return 0;
+    }
+    *value = import_csv_field(r);
+    return 1;
+}
+
+
+// One pass over every record. With set NULL it only validates and counts; otherwise it fills
+// in set, which must have been sized from the counting pass.
+static void import_pass(TraceReader *r, ProcessSet *set, long long *n_processes, long long *n_bursts, int *n_cpu_processes) {
+    long long pid = 0;
+    long long bursts = 0;
+    int cpu_bound = 0;
+    int arrival, is_cpu_bound, value;
+    import_rewind(r);
+    while (import_begin_record(r, &arrival, &is_cpu_bound)) {
+        if (set != NULL && pid == set->n_processes) {
+            import_error(r, "trace changed while it was being imported");
+        }
+        long long first = r->base + (long long)r->pos;
+        long long fields = 0;
+        while (import_next_burst(r, &value)) {
+            int is_io = (int)(fields % 2);
+            if (value < (is_io ? 0 : 1)) {
+                import_error(r, "CPU bursts must be at least 1ms and I/O bursts non-negative");
+            }
+            if (set != NULL) {
+                long long burst = bursts + fields / 2;
+                if (burst >= set->n_bursts) {
+                    import_error(r, "trace changed while it was being imported");
+                }
+                if (is_io) {
+                    stat_add(&set->io_burst_stats[is_cpu_bound], value);
+                    if (set->io_bursts != NULL) {
+                        set->io_bursts[burst - pid] = value;
+                    }
+                } else {
+                    stat_add(&set->cpu_burst_stats[is_cpu_bound], value);
+                    if (set->cpu_bursts != NULL) {
+                        set->cpu_bursts[burst] = value;
+                    }
+                }
+            }
+            fields++;
+        }
+        if (fields % 2 == 0) {
+            import_error(r, "a process must end with a CPU burst");
+        }
+        r->line++;
+
+        int num_bursts = (int)((fields + 1) / 2);
+        if (set != NULL) {
+            Process *process = &set->processes[pid];
+            process->id = (int)pid;
+            process->is_cpu_bound = is_cpu_bound;
+            process->arrival_time = arrival;
+            process->num_bursts = num_bursts;
+            set->columns.arrival_time[pid] = arrival;
+            set->columns.num_bursts[pid] = num_bursts;
+            set->columns.burst_offset[pid] = (int)bursts;
+            set->columns.is_cpu_bound[pid] = (unsigned char)is_cpu_bound;
+            if (set->columns.trace_offset != NULL) {
+                set->columns.trace_offset[pid] = first;
+            }
+        }
+        cpu_bound += is_cpu_bound;
+        bursts += num_bursts;
+        pid++;
+        if (bursts > INT_MAX || pid == INT_MAX) {
+            import_error(r, "too many processes or CPU bursts for one process set");
+        }
+    }
+    *n_processes = pid;
+    *n_bursts = bursts;
+    *n_cpu_processes = cpu_bound;
+}
+
+
+// Import the trace at path as a process set, stored or (streaming nonzero) read back on demand.
+// Sets *n_cpu_processes to the number of CPU-bound processes in the trace.
+ProcessSet import_workload(const char *path, int streaming, int *n_cpu_processes) {
+    TraceReader r;
+    memset(&r, 0, sizeof(r));
+    r.path = path;
+    r.line = 1;
+    r.fd = open(path, O_RDONLY);
+    if (r.fd < 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Unable to open trace file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    posix_fadvise(r.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    r.buffer = (unsigned char *)malloc(IMPORT_CHUNK);
+    if (r.buffer == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for trace import\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Binary traces announce themselves; anything else is CSV
+    if (import_fill(&r, IMPORT_HEADER_BYTES) && memcmp(r.buffer, IMPORT_MAGIC, 8) == 0) {
+        uint32_t version, byte_order;
+        memcpy(&version, r.buffer + 8, sizeof(version));
+        memcpy(&byte_order, r.buffer + 12, sizeof(byte_order));
+        r.binary = 1;
+        if (version != IMPORT_VERSION || byte_order != IMPORT_BYTE_ORDER) {
+            import_error(&r, "unsupported version or byte order");
+        }
+    }
+
+    long long n_processes, n_bursts, counted_processes, counted_bursts;
+    int n_cpu;
+    import_pass(&r, NULL, &n_processes, &n_bursts, &n_cpu);
+    if (n_processes == 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Trace file %s holds no processes\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    ProcessSet set = allocate_process_set((int)n_processes, (int)n_bursts, streaming ? BURSTS_TRACE : BURSTS_STORED);
+    import_pass(&r, &set, &counted_processes, &counted_bursts, &n_cpu);
+    if (counted_processes != n_processes || counted_bursts != n_bursts) {
+        import_error(&r, "trace changed while it was being imported");
+    }
+    free(r.buffer);
+    if (streaming) {
+        set.trace_fd = r.fd;
+        set.trace_binary = r.binary;
+    } else {
+        close(r.fd);
+    }
+
+    *n_cpu_processes = n_cpu;
+    build_arrival_order(&set);
+    return set;
+}
+
+
+static void import_changed(void) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Imported trace changed while it was being read\n");
+    exit(EXIT_FAILURE);
+}
+
+
+// Read the CPU burst at *offset of a trace streaming set and, when with_io, the I/O burst after
+// it, leaving *offset at the CPU burst that follows
+void import_read_burst(const ProcessSet *set, long long *offset, int with_io, int *cpu, int *io) {
+    if (set->trace_binary) {
+        int32_t values[2];
+        size_t bytes = (with_io ? 2 : 1) * sizeof(int32_t);
+        if (pread(set->trace_fd, values, bytes, *offset) != (ssize_t)bytes) {
+            import_changed();
+        }
+        *cpu = values[0];
+        if (with_io) {
+            *io = values[1];
+        }
+        *offset += (long long)bytes;
+        return;
+    }
+
+    unsigned char text[2 * IMPORT_FIELD_MAX];
+    ssize_t got = pread(set->trace_fd, text, sizeof(text), *offset);
+    if (got <= 0) {
+        import_changed();
+    }
+    size_t at = (size_t)import_parse_int(text, (size_t)got, cpu);
+    if (at == 0) {
+        import_changed();
+    }
+    if (with_io) {
+        if (at >= (size_t)got || text[at] != ',') {
+            import_changed();
+        }
+        at++;
+        int digits = import_parse_int(text + at, (size_t)got - at, io);
+        at += digits;
+        if (digits == 0 || at >= (size_t)got || text[at] != ',') {
+            import_changed();
+        }
+        *offset += (long long)at + 1;
+    }
+}
+
+#endif // IMPORT_H
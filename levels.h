@@ -0,0 +1,122 @@
+#ifndef LEVELS_H
+#define LEVELS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "trace.h"
+#include "process.h"
+#include "queue.h"
+
+#define MAX_LEVELS 64       // One bit per level in the occupancy bitmap
+
+// Ready processes split into priority levels, 0 highest, each a FIFO ring. Bit k of the bitmap
+// is set while level k is non-empty, so finding the next process to run is a single
+// count-trailing-zeros no matter how many are waiting.
+typedef struct {
+    Queue *queues[MAX_LEVELS];
+    int n_levels;
+    uint64_t bitmap;        // Non-empty levels
+} LevelQueues;
+
+// LevelQueues Functions:
+// Prototypes:
+LevelQueues* create_levels(int n_levels, int capacity);
+void levels_push(LevelQueues *levels, int level, Process *process);
+Process* levels_pop(LevelQueues *levels);
+int levels_top(LevelQueues *levels);
+bool levels_is_empty(LevelQueues *levels);
+void levels_merge_to_top(LevelQueues *levels);
+void print_levels(TraceSink *sink, LevelQueues *levels);
+void free_levels(LevelQueues *levels);
+
+// Initialize n_levels empty levels, each able to hold capacity processes
+LevelQueues* create_levels(int n_levels, int capacity) {
+    if (n_levels < 1 || n_levels > MAX_LEVELS) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Number of priority levels must be between 1 and %d\n", MAX_LEVELS);
+        exit(EXIT_FAILURE);
+    }
+    LevelQueues *levels = (LevelQueues*)malloc(sizeof(LevelQueues));
+    if (levels == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for priority levels\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n_levels; i++) {
+        levels->queues[i] = create_queue(capacity);
+    }
+    levels->n_levels = n_levels;
+    levels->bitmap = 0;
+    return levels;
+}
+
+// Add a Process to the rear of its level
+void levels_push(LevelQueues *levels, int level, Process *process) {
+    enqueue(levels->queues[level], process);
+    levels->bitmap |= (uint64_t)1 << level;
+}
+
+// Remove and return the front Process of the highest non-empty level
+Process* levels_pop(LevelQueues *levels) {
+    if (levels->bitmap == 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Priority levels are empty, cannot dequeue\n");
+        exit(EXIT_FAILURE);
+    }
+    int level = __builtin_ctzll(levels->bitmap);
+    Process *process = dequeue(levels->queues[level]);
+    if (is_empty(levels->queues[level])) {
+        levels->bitmap &= ~((uint64_t)1 << level);
+    }
+    return process;
+}
+
+// Highest non-empty level, or n_levels when nothing is queued
+int levels_top(LevelQueues *levels) {
+    return levels->bitmap == 0 ? levels->n_levels : __builtin_ctzll(levels->bitmap);
+}
+
+bool levels_is_empty(LevelQueues *levels) {
+    return levels->bitmap == 0;
+}
+
+// Priority boost: append every lower level to level 0, keeping level order then FIFO order
+void levels_merge_to_top(LevelQueues *levels) {
+    Queue *top = levels->queues[0];
+    for (int level = 1; level < levels->n_levels; level++) {
+        Queue *queue = levels->queues[level];
+        while (!is_empty(queue)) {
+            enqueue(top, dequeue(queue));
+        }
+    }
+    levels->bitmap = is_empty(top) ? 0 : 1;
+}
+
+// Print every queued process from the highest level down as one ready queue
+void print_levels(TraceSink *sink, LevelQueues *levels) {
+    trace_queue_begin(sink);
+    uint64_t bitmap = levels->bitmap;
+    while (bitmap != 0) {
+        Queue *queue = levels->queues[__builtin_ctzll(bitmap)];
+        int slot = queue->front;
+        for (int i = 0; i < queue->size; i++) {
+            trace_queue_item(sink, queue->slots[slot]);
+            if (++slot == queue->capacity) {
+                slot = 0;
+            }
+        }
+        bitmap &= bitmap - 1;
+    }
+    trace_queue_end(sink);
+}
+
+void free_levels(LevelQueues *levels) {
+    for (int i = 0; i < levels->n_levels; i++) {
+        free_queue(levels->queues[i]);
+    }
+    free(levels);
+}
+
+#endif // LEVELS_H
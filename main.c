@@ -1,57 +1,57 @@
+#include "profile.h"
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include "trace.h"
 #include "queue.h"
 #include "process.h"
+#include "timer.h"
+#include "event.h"
+#include "stats.h"
+#include "context.h"
+#include "workload.h"
+#include "bursts.h"
+#include "sweep.h"
+#include "snapshot.h"
+#include "import.h"
 #include "sim_rr.h"
 #include "sim_fcfs.h"
 #include "sim_sjf.h"
 #include "sim_srt.h"
-
-double next_exp(double lambda, double upper_bound) {
-    while (1) {
-        double r = drand48();
-        double x = -log(r) / lambda;
-        if (x <= upper_bound) {
-            return x;
-        }
-    }
-}
-
-
-// Function to generate a processes data
-void generate_process(Process *process, double lambda, double upper_bound, int is_cpu_bound) {
-    // Generate arrival time
-    process->is_cpu_bound = is_cpu_bound;
-    process->arrival_time = (int)floor(next_exp(lambda, upper_bound));
-
-    // Generate number of CPU bursts (1 to 32)
-    process->num_bursts = (int)ceil(drand48() * 32);
-
-    // Allocate memory for CPU and I/O bursts
-    process->cpu_bursts = (int *)malloc(process->num_bursts * sizeof(int));
-    process->io_bursts = (int *)malloc((process->num_bursts - 1) * sizeof(int));
-
-    // Generate CPU and I/O burst times
-    for (int i = 0; i < process->num_bursts; i++) {
-        process->cpu_bursts[i] = (int)ceil(next_exp(lambda, upper_bound)) * (is_cpu_bound ? 4 : 1);
-        if (i < process->num_bursts - 1) {
-            process->io_bursts[i] = (int)ceil(next_exp(lambda, upper_bound)) * 8 / (is_cpu_bound ? 8: 1);
-        }
-    }
-}
+#include "sim_mlfq.h"
+#include "sim_cfs.h"
+#include "sim_share.h"
+#include "sim_multi.h"
+
+// Optional flags accepted after the positional arguments
+typedef struct {
+    const char *binary_trace; // --binary-trace FILE: write the binary event log to FILE instead of text
+    int n_cpus;               // --cpus M: simulate M CPUs with the multi-CPU engine (0: classic single-CPU simulators)
+    int per_core_queues;      // --ready-queues global|per-core
+    int streaming;            // --streaming: draw bursts on demand instead of storing every process's bursts
+    const char *save_workload; // --save-workload FILE: write the generated process set to FILE
+    const char *load_workload; // --load-workload FILE: map the process set from FILE instead of generating it
+    const char *import_trace; // --import-trace FILE: take the processes and their bursts from a captured trace
+    MlfqConfig mlfq;          // --mlfq, --mlfq-levels N, --mlfq-quanta Q0,Q1,..., --mlfq-boost MS
+    CfsConfig cfs;            // --cfs, --cfs-latency MS, --cfs-granularity MS, --cfs-weights CPU,IO
+    ShareConfig share;        // --lottery, --stride, --tickets CPU,IO
+    LatencyConfig latency;    // --latency, --percentiles P1,P2,..., --histograms FILE
+    int profile;              // --profile: report internal counters and phase times (builds with -DSIM_PROFILE)
+} Options;
 
 
 void incorrectInput(char * binaryFile){
-    fprintf(stderr, "Inccorect Arguments Given, Expected Input: ./%s n_processes n_cpu_processes random_seed random_lambda random_ceiling context_switch_time alpha_sjf_srt time_slice_RR\n", binaryFile);
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Inccorect Arguments Given, Expected Input: ./%s n_processes n_cpu_processes random_seed random_lambda random_ceiling context_switch_time alpha_sjf_srt time_slice_RR [RR_ALT] [--binary-trace FILE] [--cpus M] [--ready-queues global|per-core] [--streaming] [--save-workload FILE] [--load-workload FILE] [--import-trace FILE] [--mlfq] [--mlfq-levels N] [--mlfq-quanta Q0,Q1,...] [--mlfq-boost MS] [--cfs] [--cfs-latency MS] [--cfs-granularity MS] [--cfs-weights CPU,IO] [--lottery] [--stride] [--tickets CPU,IO] [--latency] [--percentiles P1,P2,...] [--histograms FILE] [--profile]\n", binaryFile);
     exit(EXIT_FAILURE);
 }
 
 
-void handleArguments(int argc, char *argv[], int* n_processes, int* n_cpu_processes, int* random_seed, double* random_lambda, int* random_ceiling, int* context_switch_time, double* alpha_sjf_srt, int* time_slice_RR, int* rr_alt) {
+void handleArguments(int argc, char *argv[], int* n_processes, int* n_cpu_processes, int* random_seed, double* random_lambda, int* random_ceiling, int* context_switch_time, double* alpha_sjf_srt, int* time_slice_RR, int* rr_alt, Options* options) {
     // Check if the correct number of arguments is provided
-    if (argc < 9 || argc > 10) {
+    if (argc < 9) {
         incorrectInput(argv[0]);
     }
 
@@ -64,109 +64,250 @@ void handleArguments(int argc, char *argv[], int* n_processes, int* n_cpu_proces
     *context_switch_time = atoi(argv[6]);
     *alpha_sjf_srt = atof(argv[7]);
     *time_slice_RR = atoi(argv[8]);
-    if (argc == 10) {
-        *rr_alt = strcmp(argv[9], "RR_ALT") == 0;
+    *rr_alt = 0;
+    options->binary_trace = NULL;
+    options->n_cpus = 0;
+    options->per_core_queues = 0;
+    options->streaming = 0;
+    options->save_workload = NULL;
+    options->load_workload = NULL;
+    options->import_trace = NULL;
+    options->profile = 0;
+    mlfq_default_config(&options->mlfq);
+    cfs_default_config(&options->cfs);
+    share_default_config(&options->share);
+    latency_default_config(&options->latency);
+    for (int i = 9; i < argc; i++) {
+        int policy_flag = parse_mlfq_flag(argc, argv, &i, &options->mlfq);
+        if (policy_flag == 0) {
+            policy_flag = parse_cfs_flag(argc, argv, &i, &options->cfs);
+        }
+        if (policy_flag == 0) {
+            policy_flag = parse_share_flag(argc, argv, &i, &options->share);
+        }
+        if (policy_flag == 0) {
+            policy_flag = parse_latency_flag(argc, argv, &i, &options->latency);
+        }
+        if (policy_flag < 0) {
+            incorrectInput(argv[0]);
+        } else if (policy_flag > 0) {
+            continue;
+        }
+        if (strcmp(argv[i], "--binary-trace") == 0 && i + 1 < argc) {
+            options->binary_trace = argv[++i];
+        } else if (strcmp(argv[i], "--cpus") == 0 && i + 1 < argc) {
+            options->n_cpus = atoi(argv[++i]);
+            if (options->n_cpus <= 0) {
+                incorrectInput(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--ready-queues") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "global") == 0) {
+                options->per_core_queues = 0;
+            } else if (strcmp(argv[i], "per-core") == 0) {
+                options->per_core_queues = 1;
+            } else {
+                incorrectInput(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--streaming") == 0) {
+            options->streaming = 1;
+        } else if (strcmp(argv[i], "--save-workload") == 0 && i + 1 < argc) {
+            options->save_workload = argv[++i];
+        } else if (strcmp(argv[i], "--load-workload") == 0 && i + 1 < argc) {
+            options->load_workload = argv[++i];
+        } else if (strcmp(argv[i], "--import-trace") == 0 && i + 1 < argc) {
+            options->import_trace = argv[++i];
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            if (!PROFILE_BUILD) {
+                fprintf(stderr, "--profile needs a simulator built with -DSIM_PROFILE\n");
+                exit(EXIT_FAILURE);
+            }
+            options->profile = 1;
+        } else if (strcmp(argv[i], "RR_ALT") == 0 && !*rr_alt) {
+            *rr_alt = 1;
+        } else {
+            // Unknown flags and stray positional arguments
+            incorrectInput(argv[0]);
+        }
     }
-    
-
-    // Validate argument constraints
-    if (*n_processes <= 0 || *n_cpu_processes < 0 || *n_cpu_processes > *n_processes || *random_seed < 0 ||
-        *random_lambda <= 0 || *random_ceiling <= 0 || *context_switch_time <= 0 || *context_switch_time % 2 != 0 ||
-        *alpha_sjf_srt < -1 || *alpha_sjf_srt > 1 || *time_slice_RR <= 0) {
+    // MLFQ, CFS, lottery and stride run on the single-CPU engine only
+    int extra_policies = options->mlfq.enabled || options->cfs.enabled || options->share.lottery || options->share.stride;
+    if (!mlfq_finish_config(&options->mlfq) || !cfs_finish_config(&options->cfs) ||
+        (extra_policies && options->n_cpus > 0)) {
         incorrectInput(argv[0]);
     }
-}
-
-
-void assignProcessIDs(int n_processes, Process *processes) {
-    char letter = 'A';
-    int num = 0;
-
-    for (int i = 0; i < n_processes; i++) {
-        // Assign the ID directly to the Process struct
-        snprintf(processes[i].id, sizeof(processes[i].id), "%c%c", letter, (char)(num + '0'));
-        num++;
-        if (num == 10) {
-            letter++;
-            num = 0;
-        }
+    // Workload files hold materialized burst tables
+    if ((options->streaming && (options->save_workload != NULL || options->load_workload != NULL)) ||
+        (options->import_trace != NULL && options->load_workload != NULL)) {
+        incorrectInput(argv[0]);
     }
-}
 
 
-//Function to initialize a list of empty Process structs
-Process* initialize_process_list(int n_processes) {
-    Process* processes = (Process*)malloc(n_processes * sizeof(Process));
-    for (int i = 0; i < n_processes; i++) {
-        // Initialize each Process struct with default values
-        strcpy(processes[i].id, ""); // Empty ID
-        processes[i].is_cpu_bound = 0;
-        processes[i].arrival_time = 0;
-        processes[i].num_bursts = 0;
-        processes[i].cpu_bursts = NULL;
-        processes[i].io_bursts = NULL;
+    // Validate argument constraints
+    if (!valid_parameters(*n_processes, *n_cpu_processes, *random_seed, *random_lambda, *random_ceiling,
+                          *context_switch_time, *alpha_sjf_srt, *time_slice_RR)) {
+        incorrectInput(argv[0]);
     }
-    return processes;
 }
 
 
 void print_process_conditions(int n, int n_cpu, int seed, double lambda, int bound) {
-    printf("<<< -- process set (n=%d) with %d CPU-bound process%s\n", n, n_cpu, n_cpu > 1 ? "es" : "");
-    printf("<<< -- seed=%d; lambda=%.6f; bound=%d\n\n", seed, lambda, bound);
+    trace_printf(&trace_stdout, "<<< -- process set (n=%d) with %d CPU-bound process%s\n", n, n_cpu, n_cpu > 1 ? "es" : "");
+    trace_printf(&trace_stdout, "<<< -- seed=%d; lambda=%.6f; bound=%d\n\n", seed, lambda, bound);
 }
 
 
-void print_process_details(int n_processes, Process* processes) {
-    for (int i = 0; i < n_processes; i++) {
-        printf("%s-bound process %s: arrival time %dms; %d CPU burst%s:\n", 
-            (processes[i].is_cpu_bound ? "CPU" : "I/O"), processes[i].id, processes[i].arrival_time, processes[i].num_bursts, (processes[i].num_bursts > 1 ? "s" : ""));
+// List every burst of every process. Generated streaming sets get their burst statistics here,
+// since the listing is the first pass that consumes their bursts.
+void print_process_details(ProcessSet *set) {
+    Process *processes = set->processes;
+    BurstCursor bursts;
+    burst_cursor_init(&bursts, set);
+    if (set->streaming == BURSTS_GENERATED) {
+        burst_cursor_collect_stats(&bursts, set->cpu_burst_stats, set->io_burst_stats);
+    }
+    for (int i = 0; i < set->n_processes; i++) {
+        trace_printf(&trace_stdout, "%s-bound process %P: arrival time %dms; %d CPU burst%s:\n", 
+            (processes[i].is_cpu_bound ? "CPU" : "I/O"), &processes[i], processes[i].arrival_time, processes[i].num_bursts, (processes[i].num_bursts > 1 ? "s" : ""));
         for (int j = 0; j < processes[i].num_bursts; j++) {
             if (j != processes[i].num_bursts - 1) {
-                printf("==> CPU burst %dms ==> I/O burst %dms\n", processes[i].cpu_bursts[j], processes[i].io_bursts[j]);
+                trace_printf(&trace_stdout, "==> CPU burst %dms ==> I/O burst %dms\n", cpu_burst(&bursts, i, j), io_burst(&bursts, i, j));
             } else {
-                printf("==> CPU burst %dms\n\n", processes[i].cpu_bursts[j]);
+                trace_printf(&trace_stdout, "==> CPU burst %dms\n\n", cpu_burst(&bursts, i, j));
             }
         }
     }
+    burst_cursor_free(&bursts);
 }
 
 
 void print_sim_conditions(int t_cs, double alpha, int t_slice, int rr_alt) {
-    printf("<<< PROJECT SIMULATIONS\n");
+    trace_printf(&trace_stdout, "<<< PROJECT SIMULATIONS\n");
     if (alpha < 0) {
-        printf("<<< -- t_cs=%dms; alpha=<n/a>; t_slice=%dms%s\n", t_cs, t_slice, (rr_alt ? "; RR_ALT" : ""));
+        trace_printf(&trace_stdout, "<<< -- t_cs=%dms; alpha=<n/a>; t_slice=%dms%s\n", t_cs, t_slice, (rr_alt ? "; RR_ALT" : ""));
     } else {
-        printf("<<< -- t_cs=%dms; alpha=%.2f; t_slice=%dms%s\n", t_cs, alpha, t_slice, (rr_alt ? "; RR_ALT" : ""));
+        trace_printf(&trace_stdout, "<<< -- t_cs=%dms; alpha=%.2f; t_slice=%dms%s\n", t_cs, alpha, t_slice, (rr_alt ? "; RR_ALT" : ""));
     }
 }
 
 
-void print_sim_stats(int n, int n_cpu) {
+void print_sim_stats(const ProcessSet *set, int n_cpu) {
+    StatAccumulator cpu = set->cpu_burst_stats[0], io = set->io_burst_stats[0];
+    stat_merge(&cpu, &set->cpu_burst_stats[1]);
+    stat_merge(&io, &set->io_burst_stats[1]);
+
     FILE *f = fopen("simout.txt", "a");
-    fprintf(f, "-- number of processes: %d\n", n);
+    fprintf(f, "-- number of processes: %d\n", set->n_processes);
     fprintf(f, "-- number of CPU-bound processes: %d\n", n_cpu);
-    fprintf(f, "-- number of I/O-bound processes: %d\n", n - n_cpu);
-    fprintf(f, "-- CPU-bound average CPU burst time: %.3d ms\n", 0);
-    fprintf(f, "-- I/O-bound average CPU burst time: %.3d\n", 0);
-    fprintf(f, "-- overall average CPU burst time: %.3d\n", 0);
-    fprintf(f, "-- CPU-bound average I/O burst time: %.3d\n", 0);
-    fprintf(f, "-- I/O-bound average I/O burst time: %.3d\n", 0);
-    fprintf(f, "-- overall average I/O burst time: %.3d\n\n", 0);
+    fprintf(f, "-- number of I/O-bound processes: %d\n", set->n_processes - n_cpu);
+    fprintf(f, "-- CPU-bound average CPU burst time: %.3f ms\n", stat_mean(&set->cpu_burst_stats[1]));
+    fprintf(f, "-- I/O-bound average CPU burst time: %.3f ms\n", stat_mean(&set->cpu_burst_stats[0]));
+    fprintf(f, "-- overall average CPU burst time: %.3f ms\n", stat_mean(&cpu));
+    fprintf(f, "-- CPU-bound average I/O burst time: %.3f ms\n", stat_mean(&set->io_burst_stats[1]));
+    fprintf(f, "-- I/O-bound average I/O burst time: %.3f ms\n", stat_mean(&set->io_burst_stats[0]));
+    fprintf(f, "-- overall average I/O burst time: %.3f ms\n\n", stat_mean(&io));
+    fclose(f);
+}
+
+
+// Write the latency percentiles and histogram dump of the run just finished, if it recorded any,
+// then clear the histograms for the next run
+void append_latency(FILE *f, const SimStats *stats, const SimContext *ctx, const LatencyConfig *config, FILE *dump) {
+    if (ctx->latency == NULL) {
+        return;
+    }
+    if (config->report) {
+        write_latency_percentiles(f, ctx->latency, config);
+    }
+    if (dump != NULL) {
+        write_latency_dump(dump, stats->algorithm, ctx->latency);
+    }
+    memset(ctx->latency, 0, sizeof(*ctx->latency));
+}
+
+
+// Append one algorithm's stats to simout.txt, ending the profile phase of its run first
+void append_sim_stats(const SimStats *stats, const SimContext *ctx, const LatencyConfig *config, FILE *dump, Profiler *profiler) {
+    profile_phase(profiler, stats->algorithm);
+    FILE *f = fopen("simout.txt", "a");
+    write_sim_stats(f, stats);
+    if (stats->has_slice_stats && ctx->latency != NULL && config->report) {
+        fprintf(f, "\n");
+    }
+    append_latency(f, stats, ctx, config, dump);
     fclose(f);
+    profile_output_done(profiler);
+}
+
 
-// -- number of CPU-bound processes: 1
-// -- number of I/O-bound processes: 2
-// -- CPU-bound average CPU burst time: 1600.640 ms
-// -- I/O-bound average CPU burst time: 247.300 ms
-// -- overall average CPU burst time: 999.156 ms
-// -- CPU-bound average I/O burst time: 419.084 ms
-// -- I/O-bound average I/O burst time: 3277.778 ms
-// -- overall average I/O burst time: 1644.239 ms
+// Run all four policies on options->n_cpus CPUs and append their stats with the per-core breakdown
+void run_multi_cpu(const SimContext *ctx, const Options *options, FILE *dump, Profiler *profiler, int tcs, double alpha, double lambda, int t_slice, int rr_alt) {
+    MultiStats multi;
+    multi.cores = (CoreStats *)malloc(options->n_cpus * sizeof(CoreStats));
+    if (multi.cores == NULL) {
+        trace_flush(ctx->trace);
+        fprintf(stderr, "Memory allocation failed for per-core stats\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int policy = MULTI_FCFS; policy <= MULTI_RR; policy++) {
+        MultiConfig config = { policy, options->n_cpus, options->per_core_queues, tcs, alpha, lambda, t_slice, rr_alt };
+        SimStats stats = simulate_multi(ctx, &config, &multi);
+        profile_phase(profiler, stats.algorithm);
+        FILE *f = fopen("simout.txt", "a");
+        write_sim_stats(f, &stats);
+        if (stats.has_slice_stats) {
+            fprintf(f, "\n");
+        }
+        write_multi_stats(f, &multi);
+        append_latency(f, &stats, ctx, &options->latency, dump);
+        fclose(f);
+        profile_output_done(profiler);
+    }
+    trace_flush(ctx->trace);
+    free(multi.cores);
+}
+
+
+// Run the single-CPU policies in order, appending each one's stats as it finishes
+void run_single_cpu(const SimContext *ctx, const Options *options, FILE *dump, Profiler *profiler, int seed, int tcs, double alpha, double lambda, int t_slice, int rr_alt) {
+    SimStats stats = simulate_fcfs(ctx, tcs);
+    append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    stats = simulate_sjf(ctx, tcs, alpha, lambda);
+    append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    if (alpha < 0) {
+        stats = simulate_srt_actual(ctx, tcs, lambda);
+    } else {
+        stats = simulate_srt(ctx, tcs, alpha, lambda);
+    }
+    append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    stats = simulate_rr(ctx, tcs, t_slice, rr_alt);
+    append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    if (options->mlfq.enabled) {
+        stats = simulate_mlfq(ctx, tcs, t_slice, &options->mlfq);
+        append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    }
+    if (options->cfs.enabled) {
+        stats = simulate_cfs(ctx, tcs, &options->cfs);
+        append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    }
+    if (options->share.lottery) {
+        stats = simulate_lottery(ctx, tcs, t_slice, &options->share, seed);
+        append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    }
+    if (options->share.stride) {
+        stats = simulate_stride(ctx, tcs, t_slice, &options->share);
+        append_sim_stats(&stats, ctx, &options->latency, dump, profiler);
+    }
+    trace_flush(ctx->trace);
 }
 
 
 int main(int argc, char** argv) {
-    setvbuf( stdout, NULL, _IONBF, 0 );
+    if (argc > 1 && strcmp(argv[1], "--sweep") == 0) {
+        return run_sweep(argc, argv);
+    }
+
     int n_processes;
     int n_cpu_processes;
     int random_seed;
@@ -176,32 +317,78 @@ int main(int argc, char** argv) {
     double alpha_sjf_srt;
     int time_slice_RR;
     int rr_alt;
-    handleArguments(argc, argv, &n_processes, &n_cpu_processes, &random_seed, &random_lambda, &random_ceiling, &context_switch_time, &alpha_sjf_srt, &time_slice_RR, &rr_alt);
-
-    // char** processIds = assignProcessIDs(n_processes);
-
-    Process* processes = initialize_process_list(n_processes);
-    assignProcessIDs(n_processes, processes);
-
-    srand48(random_seed);
+    Options options;
+    handleArguments(argc, argv, &n_processes, &n_cpu_processes, &random_seed, &random_lambda, &random_ceiling, &context_switch_time, &alpha_sjf_srt, &time_slice_RR, &rr_alt, &options);
+    Profiler profiler;
+    profile_start(&profiler, options.profile);
+
+    if (options.binary_trace != NULL) {
+        int fd = open(options.binary_trace, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "Unable to open binary trace file %s\n", options.binary_trace);
+            exit(EXIT_FAILURE);
+        }
+        trace_open_binary(&trace_stdout, fd);
+    }
 
-    for (int i  = 0; i <  n_processes; i++) {
-        generate_process(&processes[i], random_lambda, random_ceiling, (i < n_cpu_processes ? 1 : 0));
+    ProcessSet set;
+    if (options.import_trace != NULL) {
+        // The trace decides how many processes there are and which are CPU-bound
+        set = import_workload(options.import_trace, options.streaming, &n_cpu_processes);
+        n_processes = set.n_processes;
+        set.lambda = random_lambda;
+        set.upper_bound = random_ceiling;
+    } else if (options.load_workload != NULL) {
+        set = load_workload_snapshot(options.load_workload, n_processes, n_cpu_processes, random_seed, random_lambda, random_ceiling);
+    } else if (options.streaming) {
+        set = generate_streaming_workload(n_processes, n_cpu_processes, random_seed, random_lambda, random_ceiling);
+    } else {
+        set = generate_workload(n_processes, n_cpu_processes, random_seed, random_lambda, random_ceiling,
+                                (int)sysconf(_SC_NPROCESSORS_ONLN));
     }
+    if (options.save_workload != NULL) {
+        write_workload_snapshot(options.save_workload, &set, n_cpu_processes, random_seed);
+    }
+    profile_phase(&profiler, "generation");
+    Process* processes = set.processes;
+    trace_set_processes(&trace_stdout, processes);
 
     print_process_conditions(n_processes, n_cpu_processes, random_seed, random_lambda, random_ceiling);
-    print_process_details(n_processes, processes);
+    print_process_details(&set);
     print_sim_conditions(context_switch_time, alpha_sjf_srt, time_slice_RR, rr_alt);
 
-    print_sim_stats(n_processes, n_cpu_processes);
+    print_sim_stats(&set, n_cpu_processes);
+
+    // Latency histograms are only recorded when something will report them
+    LatencyHistograms *latency = NULL;
+    FILE *dump = NULL;
+    if (options.latency.report || options.latency.dump != NULL) {
+        latency = (LatencyHistograms *)calloc(1, sizeof(LatencyHistograms));
+        if (latency == NULL) {
+            trace_flush(&trace_stdout);
+            fprintf(stderr, "Memory allocation failed for latency histograms\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (options.latency.dump != NULL && (dump = fopen(options.latency.dump, "w")) == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Unable to open histogram file %s\n", options.latency.dump);
+        exit(EXIT_FAILURE);
+    }
+
+    profile_output_done(&profiler);
 
     // simulations:
-    simulate_fcfs(processes, n_processes, context_switch_time);
-    simulate_sjf(processes, n_processes, context_switch_time, alpha_sjf_srt, random_lambda);
-    if (alpha_sjf_srt < 0) {
-        simulate_srt_actual(processes, n_processes, context_switch_time, random_lambda);
+    SimContext ctx = { &set, &trace_stdout, latency };
+    if (options.n_cpus > 0) {
+        run_multi_cpu(&ctx, &options, dump, &profiler, context_switch_time, alpha_sjf_srt, random_lambda, time_slice_RR, rr_alt);
     } else {
-        simulate_srt(processes, n_processes, context_switch_time, alpha_sjf_srt, random_lambda);
+        run_single_cpu(&ctx, &options, dump, &profiler, random_seed, context_switch_time, alpha_sjf_srt, random_lambda, time_slice_RR, rr_alt);
+    }
+    if (dump != NULL) {
+        fclose(dump);
     }
-    simulate_rr(processes, n_processes, context_switch_time, time_slice_RR, rr_alt);
+    free(latency);
+    profile_finish(&profiler);
+    return 0;
 }
@@ -1,14 +1,210 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "rand48.h"
+#include "stats.h"
+
 typedef struct {
-    char id[3]; // Process ID (e.g., "A0\0", "B1\0")
+    int id; // Numeric ID, equal to the process's index; names like "A0" are formatted only for output
     int is_cpu_bound;
     int arrival_time; 
-    int num_bursts; // Number of CPU bursts
-    int *cpu_bursts; // Array of CPU burst times
-    int *io_bursts; // Array of I/O burst times
-    int index;
+    int num_bursts; // Number of CPU bursts; the bursts themselves are read through a BurstCursor (bursts.h)
 } Process;
 
+// Longest process name format_process_id can produce, with its terminator
+#define PROCESS_NAME_MAX 16
+
+// Process name for a given index: A0..A9, B0..B9, ..., Z9, then AA0..AZ9, BA0, ... with the
+// letters counting in bijective base 26. Returns the length of the name.
+int format_process_id(int index, char id[PROCESS_NAME_MAX]) {
+    char letters[PROCESS_NAME_MAX];
+    int n_letters = 0;
+    int group = index / 10;
+    do {
+        letters[n_letters++] = (char)('A' + group % 26);
+        group = group / 26 - 1;
+    } while (group >= 0);
+
+    int length = 0;
+    while (n_letters > 0) {
+        id[length++] = letters[--n_letters];
+    }
+    id[length++] = (char)('0' + index % 10);
+    id[length] = '\0';
+    return length;
+}
+
+// Where a set's bursts come from, as ProcessSet.streaming
+#define BURSTS_STORED 0         // The set's burst tables
+#define BURSTS_GENERATED 1      // Drawn on demand from per-process generators
+#define BURSTS_TRACE 2          // Read on demand from an imported trace file
+
+// Every section of a process set's arena starts on its own cache line
+#define PROCESS_ARENA_ALIGN 64
+
+// Struct-of-arrays copy of the per-process fields, for passes that scan one field across every process
+typedef struct {
+    int *arrival_time;
+    int *num_bursts;
+    int *burst_offset;          // Index of process i's first CPU burst; its I/O bursts start at burst_offset[i] - i
+    unsigned char *is_cpu_bound;
+    Rand48 *burst_rng;          // Generated streaming sets only: generator positioned at process i's first CPU burst
+    long long *trace_offset;    // Trace streaming sets only: file offset of process i's first CPU burst
+} ProcessColumns;
+
+// Generated processes shared read-only by every simulator
+typedef struct {
+    Process *processes; // Array of processes
+    int n_processes; // Number of processes
+    int *arrival_order; // Process indices sorted by (arrival_time, index)
+    ProcessColumns columns;
+    int *cpu_bursts;            // Every process's CPU bursts back to back, in process order; NULL when streaming
+    int *io_bursts;             // Likewise for I/O bursts; n_bursts - n_processes of them
+    int n_bursts;               // Total CPU bursts
+    int streaming;              // BURSTS_*; nonzero sets are read through a BurstCursor instead of stored
+    int trace_fd;               // Trace streaming sets only: the trace the bursts are read from, else -1
+    int trace_binary;           // The trace is in the binary format rather than CSV
+    double lambda;              // Generation parameters, kept for drawing streamed bursts
+    int upper_bound;
+    StatAccumulator cpu_burst_stats[2];     // Burst times drawn by the generator, indexed by is_cpu_bound
+    StatAccumulator io_burst_stats[2];
+    void *arena;                // Single allocation holding everything above
+    size_t mapped_size;         // Length of the read-only file mapping arena points into; 0 when allocated
+} ProcessSet;
+
+// Byte offset of each section of a process set's arena, and the arena's size
+typedef struct {
+    size_t processes;
+    size_t order;
+    size_t arrival;
+    size_t num_bursts;
+    size_t burst_offset;
+    size_t cpu_bound;
+    size_t rng;
+    size_t trace_offset;
+    size_t cpu_bursts;
+    size_t io_bursts;
+    size_t size;
+} ProcessSetLayout;
+
+// Reserve the next cache-line-aligned section of bytes in an arena being laid out
+static size_t arena_section(size_t *arena_size, size_t bytes) {
+    size_t offset = *arena_size;
+    *arena_size += (bytes + PROCESS_ARENA_ALIGN - 1) / PROCESS_ARENA_ALIGN * PROCESS_ARENA_ALIGN;
+    return offset;
+}
+
+// Arena layout for n_processes processes with n_bursts CPU bursts between them. A streaming set
+// has per-process generators or trace offsets in place of the burst tables.
+ProcessSetLayout process_set_layout(int n_processes, int n_bursts, int streaming) {
+    size_t table_bursts = streaming ? 0 : (size_t)n_bursts;
+    ProcessSetLayout layout;
+    layout.size = 0;
+    layout.processes = arena_section(&layout.size, n_processes * sizeof(Process));
+    layout.order = arena_section(&layout.size, n_processes * sizeof(int));
+    layout.arrival = arena_section(&layout.size, n_processes * sizeof(int));
+    layout.num_bursts = arena_section(&layout.size, n_processes * sizeof(int));
+    layout.burst_offset = arena_section(&layout.size, n_processes * sizeof(int));
+    layout.cpu_bound = arena_section(&layout.size, n_processes * sizeof(unsigned char));
+    layout.rng = arena_section(&layout.size, streaming == BURSTS_GENERATED ? n_processes * sizeof(Rand48) : 0);
+    layout.trace_offset = arena_section(&layout.size, streaming == BURSTS_TRACE ? n_processes * sizeof(long long) : 0);
+    layout.cpu_bursts = arena_section(&layout.size, table_bursts * sizeof(int));
+    layout.io_bursts = arena_section(&layout.size, (streaming ? 0 : table_bursts - n_processes) * sizeof(int));
+    return layout;
+}
+
+// A set whose arrays point into an arena laid out by process_set_layout
+ProcessSet bind_process_set(char *arena, const ProcessSetLayout *layout, int n_processes, int n_bursts, int streaming) {
+    ProcessSet set;
+    set.processes = (Process *)(arena + layout->processes);
+    set.n_processes = n_processes;
+    set.arrival_order = (int *)(arena + layout->order);
+    set.columns.arrival_time = (int *)(arena + layout->arrival);
+    set.columns.num_bursts = (int *)(arena + layout->num_bursts);
+    set.columns.burst_offset = (int *)(arena + layout->burst_offset);
+    set.columns.is_cpu_bound = (unsigned char *)(arena + layout->cpu_bound);
+    set.columns.burst_rng = (streaming == BURSTS_GENERATED) ? (Rand48 *)(arena + layout->rng) : NULL;
+    set.columns.trace_offset = (streaming == BURSTS_TRACE) ? (long long *)(arena + layout->trace_offset) : NULL;
+    set.cpu_bursts = streaming ? NULL : (int *)(arena + layout->cpu_bursts);
+    set.io_bursts = streaming ? NULL : (int *)(arena + layout->io_bursts);
+    set.n_bursts = n_bursts;
+    set.streaming = streaming;
+    set.trace_fd = -1;
+    set.trace_binary = 0;
+    set.lambda = 0;
+    set.upper_bound = 0;
+    memset(set.cpu_burst_stats, 0, sizeof(set.cpu_burst_stats));
+    memset(set.io_burst_stats, 0, sizeof(set.io_burst_stats));
+    set.arena = arena;
+    set.mapped_size = 0;
+    return set;
+}
+
+// Allocate a set for n_processes processes with n_bursts CPU bursts between them, as one arena.
+// The caller fills in the processes, the columns and the burst tables, then builds the arrival schedule.
+ProcessSet allocate_process_set(int n_processes, int n_bursts, int streaming) {
+    ProcessSetLayout layout = process_set_layout(n_processes, n_bursts, streaming);
+    char *arena = (char *)aligned_alloc(PROCESS_ARENA_ALIGN, layout.size);
+    if (arena == NULL) {
+        fprintf(stderr, "Memory allocation failed for process set\n");
+        exit(EXIT_FAILURE);
+    }
+    return bind_process_set(arena, &layout, n_processes, n_bursts, streaming);
+}
+
+// Arrival schedule entry used while sorting
+typedef struct {
+    int arrival_time;
+    int index;
+} ArrivalKey;
+
+static int compare_arrivals(const void *a, const void *b) {
+    const ArrivalKey *x = (const ArrivalKey *)a;
+    const ArrivalKey *y = (const ArrivalKey *)b;
+    if (x->arrival_time != y->arrival_time) {
+        return (x->arrival_time < y->arrival_time) ? -1 : 1;
+    }
+    return x->index - y->index;
+}
+
+// Sort the set's processes into its arrival schedule
+void build_arrival_order(ProcessSet *set) {
+    int n_processes = set->n_processes;
+    ArrivalKey *keys = (ArrivalKey *)malloc(n_processes * sizeof(ArrivalKey));
+    if (keys == NULL) {
+        fprintf(stderr, "Memory allocation failed for arrival schedule\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < n_processes; i++) {
+        keys[i].arrival_time = set->columns.arrival_time[i];
+        keys[i].index = i;
+    }
+    qsort(keys, n_processes, sizeof(ArrivalKey), compare_arrivals);
+    for (int i = 0; i < n_processes; i++) {
+        set->arrival_order[i] = keys[i].index;
+    }
+
+    free(keys);
+}
+
+// Release a set from allocate_process_set; its processes and bursts all live in the one arena
+void free_process_set(ProcessSet *set) {
+    if (set->trace_fd >= 0) {
+        close(set->trace_fd);
+        set->trace_fd = -1;
+    }
+    if (set->mapped_size != 0) {
+        munmap(set->arena, set->mapped_size);
+    } else {
+        free(set->arena);
+    }
+    set->arena = NULL;
+}
+
 #endif // PROCESS_H
@@ -0,0 +1,169 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+// Internal counters for finding where long runs spend their time. They are only compiled in
+// by a build with -DSIM_PROFILE; otherwise every PROFILE_* macro expands to nothing and --profile
+// is rejected. Counters are thread-local so parameter sweeps running simulators on several
+// threads stay correct, and are read and cleared at the end of each phase.
+#ifdef SIM_PROFILE
+#define PROFILE_BUILD 1
+#else
+#define PROFILE_BUILD 0
+#endif
+
+typedef struct {
+    long long loop_iterations;      // Passes through a scheduler's event loop
+    long long event_iterations;     // Passes that handled at least one event
+    long long events;               // Arrivals, I/O completions, run ends, dispatches and announcements
+    long long events_before;        // events when the current pass began
+    long long arrival_scans;        // Arrival checks
+    long long io_scans;             // I/O completion checks
+    long long queue_inserts;        // Processes put into a ready queue
+    long long queue_compares;       // Key comparisons made by the ready queues
+    long long allocations;          // malloc, calloc, realloc and aligned_alloc calls
+    long long allocated_bytes;
+    long long trace_bytes;          // Bytes handed to the trace sink
+} ProfileCounters;
+
+static _Thread_local ProfileCounters profile_counters;
+
+#ifdef SIM_PROFILE
+#define PROFILE_COUNT(counter) ((void)profile_counters.counter++)
+#define PROFILE_ADD(counter, n) ((void)(profile_counters.counter += (long long)(n)))
+#define PROFILE_LOOP_BEGIN() ((void)(profile_counters.loop_iterations++, profile_counters.events_before = profile_counters.events))
+#define PROFILE_LOOP_END() ((void)(profile_counters.event_iterations += profile_counters.events != profile_counters.events_before))
+
+// Allocator calls made by the code included after this header are counted by routing them
+// through these wrappers, unless the includer already wrapped them itself (bench.c does).
+#ifndef malloc
+static void* profile_malloc(size_t size) {
+    PROFILE_COUNT(allocations);
+    PROFILE_ADD(allocated_bytes, size);
+    return malloc(size);
+}
+
+static void* profile_calloc(size_t count, size_t size) {
+    PROFILE_COUNT(allocations);
+    PROFILE_ADD(allocated_bytes, count * size);
+    return calloc(count, size);
+}
+
+static void* profile_realloc(void *pointer, size_t size) {
+    PROFILE_COUNT(allocations);
+    PROFILE_ADD(allocated_bytes, size);
+    return realloc(pointer, size);
+}
+
+static void* profile_aligned_alloc(size_t alignment, size_t size) {
+    PROFILE_COUNT(allocations);
+    PROFILE_ADD(allocated_bytes, size);
+    return aligned_alloc(alignment, size);
+}
+
+#define malloc profile_malloc
+#define calloc profile_calloc
+#define realloc profile_realloc
+#define aligned_alloc profile_aligned_alloc
+#endif
+#else
+#define PROFILE_COUNT(counter) ((void)0)
+#define PROFILE_ADD(counter, n) ((void)0)
+#define PROFILE_LOOP_BEGIN() ((void)0)
+#define PROFILE_LOOP_END() ((void)0)
+#endif
+
+// Wall time of the phases of one command line run, with the counters of the output phases
+typedef struct {
+    int enabled;                // --profile was given
+    double start;               // When profiling began
+    double mark;                // When the current phase began
+    double output_ms;           // Time spent writing stats, summed over every output phase
+    ProfileCounters output;     // Counters of the output phases
+} Profiler;
+
+// Profile Functions:
+// Prototypes:
+double profile_now_ms(void);
+void profile_start(Profiler *profiler, int enabled);
+void profile_phase(Profiler *profiler, const char *phase);
+void profile_output_done(Profiler *profiler);
+void profile_finish(Profiler *profiler);
+
+
+double profile_now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+
+static void profile_write_counters(FILE *f, const char *phase, double wall_ms, const ProfileCounters *c) {
+    fprintf(f, "profile %s: wall time %.3f ms\n", phase, wall_ms);
+    fprintf(f, "-- loop iterations: %lld (%lld with events, %lld events)\n", c->loop_iterations, c->event_iterations, c->events);
+    fprintf(f, "-- arrival scans: %lld; I/O scans: %lld\n", c->arrival_scans, c->io_scans);
+    fprintf(f, "-- queue inserts: %lld; queue comparisons: %lld\n", c->queue_inserts, c->queue_compares);
+    fprintf(f, "-- allocations: %lld (%lld bytes)\n", c->allocations, c->allocated_bytes);
+    fprintf(f, "-- trace bytes: %lld\n", c->trace_bytes);
+}
+
+
+// Clear the counters and start timing the first phase
+void profile_start(Profiler *profiler, int enabled) {
+    profiler->enabled = enabled;
+    profiler->start = profiler->mark = profile_now_ms();
+    profiler->output_ms = 0;
+    profile_counters = (ProfileCounters){ 0 };
+    profiler->output = profile_counters;
+}
+
+
+// End the phase begun at the last mark, reporting its wall time and counters to stderr
+void profile_phase(Profiler *profiler, const char *phase) {
+    if (!profiler->enabled) {
+        return;
+    }
+    double now = profile_now_ms();
+    profile_write_counters(stderr, phase, now - profiler->mark, &profile_counters);
+    profile_counters = (ProfileCounters){ 0 };
+    profiler->mark = profile_now_ms();
+}
+
+
+// End an output phase, which is reported with the others of its kind by profile_finish
+void profile_output_done(Profiler *profiler) {
+    if (!profiler->enabled) {
+        return;
+    }
+    double now = profile_now_ms();
+    ProfileCounters *sum = &profiler->output;
+    profiler->output_ms += now - profiler->mark;
+    sum->loop_iterations += profile_counters.loop_iterations;
+    sum->event_iterations += profile_counters.event_iterations;
+    sum->events += profile_counters.events;
+    sum->arrival_scans += profile_counters.arrival_scans;
+    sum->io_scans += profile_counters.io_scans;
+    sum->queue_inserts += profile_counters.queue_inserts;
+    sum->queue_compares += profile_counters.queue_compares;
+    sum->allocations += profile_counters.allocations;
+    sum->allocated_bytes += profile_counters.allocated_bytes;
+    sum->trace_bytes += profile_counters.trace_bytes;
+    profile_counters = (ProfileCounters){ 0 };
+    profiler->mark = now;
+}
+
+
+// Report the output phases together, then the wall time of the whole run
+void profile_finish(Profiler *profiler) {
+    if (!profiler->enabled) {
+        return;
+    }
+    profile_output_done(profiler);
+    profile_write_counters(stderr, "stats output", profiler->output_ms, &profiler->output);
+    fprintf(stderr, "profile total: wall time %.3f ms\n", profile_now_ms() - profiler->start);
+}
+
+#endif // PROFILE_H
@@ -4,79 +4,77 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h> 
+#include "trace.h"
+#include "profile.h"
 #include "process.h"
 
-// Node structure for the queue
-typedef struct Node {
-    Process *process;       // Pointer to the Process struct
-    struct Node *next;      // Pointer to the next node in the queue
-} Node;
-
-// Queue structure
+// Queue structure: fixed-capacity ring buffer of Process pointers
 typedef struct {
-    Node *front;            // Pointer to the front of the queue
-    Node *rear;             // Pointer to the rear of the queue
+    Process **slots;        // Ring storage, allocated once at creation
+    int front;              // Slot holding the front of the queue
     int size;               // Current size of the queue
+    int capacity;           // Maximum number of queued processes
 } Queue;
 
 // Queue Functions:
 // Prototypes:
-Queue* create_queue();
+Queue* create_queue(int capacity);
 void enqueue(Queue *queue, Process *process);
+void enqueue_front(Queue *queue, Process *process);
 Process* dequeue(Queue *queue);
 bool is_empty(Queue *queue);
 int queue_size(Queue *queue);
+void print_queue(TraceSink *sink, Queue *q);
 void free_queue(Queue *queue);
 
-// Initalize queue
-Queue* create_queue() {
+// Initalize a queue able to hold capacity processes
+Queue* create_queue(int capacity) {
     Queue *queue = (Queue*)malloc(sizeof(Queue));
     if (queue == NULL) {
+        trace_flush(&trace_stdout);
         fprintf(stderr, "Memory allocation failed for queue\n");
         exit(EXIT_FAILURE);
     }
-    queue->front = NULL;
-    queue->rear = NULL;
+    queue->slots = (Process**)malloc(capacity * sizeof(Process*));
+    if (queue->slots == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for queue slots\n");
+        exit(EXIT_FAILURE);
+    }
+    queue->front = 0;
     queue->size = 0;
+    queue->capacity = capacity;
     return queue;
 }
 
 // Add a Process to the rear of the queue
 void enqueue(Queue *queue, Process *process) {
-    Node *new_node = (Node*)malloc(sizeof(Node));
-    if (new_node == NULL) {
-        fprintf(stderr, "Memory allocation failed for new node\n");
+    if (queue->size == queue->capacity) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Queue is full, cannot enqueue\n");
         exit(EXIT_FAILURE);
     }
-    new_node->process = process;
-    new_node->next = NULL;
 
-    if (is_empty(queue)) {
-        queue->front = new_node;
-    } else {
-        queue->rear->next = new_node;
+    PROFILE_COUNT(queue_inserts);
+    int rear = queue->front + queue->size;
+    if (rear >= queue->capacity) {
+        rear -= queue->capacity;
     }
-    queue->rear = new_node;
+    queue->slots[rear] = process;
     queue->size++;
 }
 
 // Add a Process to the front of the queue
 void enqueue_front(Queue *queue, Process *process) {
-    Node *new_node = (Node*)malloc(sizeof(Node));
-    if (new_node == NULL) {
-        fprintf(stderr, "Memory allocation failed for front node\n");
+    if (queue->size == queue->capacity) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Queue is full, cannot enqueue at front\n");
         exit(EXIT_FAILURE);
     }
 
-    new_node->process = process;
-    new_node->next = queue->front;
-    queue->front = new_node;
-
-    // If queue is empty, update rear too
-    if (queue->rear == NULL) {
-        queue->rear = new_node;
-    }
-
+    PROFILE_COUNT(queue_inserts);
+    queue->front = (queue->front == 0) ? queue->capacity - 1 : queue->front - 1;
+    queue->slots[queue->front] = process;
     queue->size++;
 }
 
@@ -84,19 +82,16 @@ void enqueue_front(Queue *queue, Process *process) {
 // Remove and return the Process at the front of the queue
 Process* dequeue(Queue *queue) {
     if (is_empty(queue)) {
+        trace_flush(&trace_stdout);
         fprintf(stderr, "Queue is empty, cannot dequeue\n");
         exit(EXIT_FAILURE);
     }
 
-    Node *temp = queue->front;
-    Process *process = temp->process;
-
-    queue->front = queue->front->next;
-    if (queue->front == NULL) {
-        queue->rear = NULL; // Queue is now empty
+    Process *process = queue->slots[queue->front];
+    queue->front++;
+    if (queue->front == queue->capacity) {
+        queue->front = 0;
     }
-
-    free(temp);
     queue->size--;
     return process;
 }
@@ -111,25 +106,21 @@ int queue_size(Queue *queue) {
     return queue->size;
 }
 
-void print_queue(Queue *q) {
-    printf("[Q");
-    if (is_empty(q)) {
-        printf(" empty");
-    } else {
-        Node *curr = q->front;
-        while (curr != NULL) {
-            printf(" %s", curr->process->id);
-            curr = curr->next;
+void print_queue(TraceSink *sink, Queue *q) {
+    trace_queue_begin(sink);
+    int slot = q->front;
+    for (int i = 0; i < q->size; i++) {
+        trace_queue_item(sink, q->slots[slot]);
+        if (++slot == q->capacity) {
+            slot = 0;
         }
     }
-    printf("]\n");
+    trace_queue_end(sink);
 }
 
-// Free the queue and all its nodes
+// Free the queue and its ring storage
 void free_queue(Queue *queue) {
-    while (!is_empty(queue)) {
-        dequeue(queue);
-    }
+    free(queue->slots);
     free(queue);
 }
 
@@ -0,0 +1,382 @@
+// Microbenchmarks for the ready queues on the simulators' inner loop: the FIFO ring deque in
+// queue.h and the red-black tree SJF and SRT queue into through the SRT sorted-insert helper, next
+// to the indexed heap in heap.h and a linear sorted insert into the ring for comparison. Each implementation runs the same
+// scenarios at several queue depths and reports ns/op with its standard deviation over rounds,
+// and cache misses per op where the kernel allows hardware counters.
+//
+// Build: gcc -O2 -o queue_bench queue_bench.c -lm -lpthread
+// Usage: ./queue_bench [--rounds N] [--ops N] [--max-depth N] [--impls NAME,NAME,...]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "trace.h"
+#include "process.h"
+#include "stats.h"
+#include "rand48.h"
+#include "queue.h"
+#include "heap.h"
+#include "rbtree.h"
+#include "sim_srt.h"
+
+#define QBENCH_DEFAULT_ROUNDS 7
+#define QBENCH_DEFAULT_OPS (1 << 18)        // Operations per round
+#define QBENCH_DEFAULT_MAX_DEPTH (1 << 20)
+#define QBENCH_KEY_RANGE 4096               // Keys are drawn from [1, QBENCH_KEY_RANGE], like burst times
+#define QBENCH_SEED 12345
+
+static const int qbench_depths[] = { 16, 256, 4096, 65536, 1 << 20 };
+#define QBENCH_DEPTHS ((int)(sizeof(qbench_depths) / sizeof(qbench_depths[0])))
+
+// State shared by every implementation: the processes being queued, their keys and the queues
+typedef struct {
+    Process *processes;
+    int *keys;                  // Sort key of each process, read by the sorted implementations
+    Queue *queue;
+    ReadyHeap *heap;
+    ReadyTree *tree;
+    TraceSink *sink;            // Text sink on /dev/null for the print scenario
+    Rand48 rng;
+    int next_key;               // FIFO scenarios hand out increasing keys
+} QueueBench;
+
+// One ready queue implementation under test. Adding an entry to qbench_impls is all it takes
+// to compare another one.
+typedef struct {
+    const char *name;
+    int sorted;                 // Orders by key; otherwise FIFO
+    int max_depth;              // Deepest queue it is run at; 0 for no limit
+    void (*create)(QueueBench *b, int capacity);
+    void (*push)(QueueBench *b, Process *process);
+    void (*reinsert)(QueueBench *b, Process *process);      // Put back a preempted process
+    Process* (*pop)(QueueBench *b);
+    void (*print)(QueueBench *b);
+    void (*destroy)(QueueBench *b);
+} QueueImpl;
+
+
+// Ring deque: FIFO, with preempted processes put back at the front
+
+static void ring_create(QueueBench *b, int capacity) { b->queue = create_queue(capacity); }
+static void ring_push(QueueBench *b, Process *process) { enqueue(b->queue, process); }
+static void ring_reinsert(QueueBench *b, Process *process) { enqueue_front(b->queue, process); }
+static Process* ring_pop(QueueBench *b) { return dequeue(b->queue); }
+static void ring_print(QueueBench *b) { print_queue(b->sink, b->queue); }
+static void ring_destroy(QueueBench *b) { free_queue(b->queue); }
+
+
+// Ring deque kept sorted by (key, id) with a linear insert, as the ready queues were before the heap
+static void sorted_ring_push(QueueBench *b, Process *process) {
+    Queue *queue = b->queue;
+    if (queue->size == queue->capacity) {
+        fprintf(stderr, "Queue is full, cannot enqueue\n");
+        exit(EXIT_FAILURE);
+    }
+    int key = b->keys[process->id];
+    int i = queue->size;
+    while (i > 0) {
+        int slot = (queue->front + i - 1) % queue->capacity;
+        const Process *other = queue->slots[slot];
+        if (b->keys[other->id] < key || (b->keys[other->id] == key && other->id < process->id)) {
+            break;
+        }
+        queue->slots[(slot + 1) % queue->capacity] = queue->slots[slot];
+        i--;
+    }
+    queue->slots[(queue->front + i) % queue->capacity] = process;
+    queue->size++;
+}
+
+
+// Indexed heap ordered by (key, id), as SJF and SRT queued before the tree
+
+static void heap_create(QueueBench *b, int capacity) { b->heap = create_heap(b->processes, capacity); }
+static void heap_push_sorted(QueueBench *b, Process *process) { heap_push(b->heap, process, b->keys[process->id], 0, process->id); }
+static Process* heap_pop_min(QueueBench *b) { return heap_pop(b->heap); }
+static void heap_print(QueueBench *b) { print_heap(b->sink, b->heap); }
+static void heap_destroy(QueueBench *b) { free_heap(b->heap); }
+
+
+// Red-black tree through the SRT sorted-insert helper
+
+static void tree_create(QueueBench *b, int capacity) { b->tree = create_tree(b->processes, capacity); }
+static void tree_push(QueueBench *b, Process *process) { enqueue_sorted_by_remaining_time(b->tree, process, b->keys); }
+static Process* tree_pop(QueueBench *b) { return tree_pop_min(b->tree); }
+static void tree_print(QueueBench *b) { print_tree(b->sink, b->tree); }
+static void tree_destroy(QueueBench *b) { free_tree(b->tree); }
+
+
+static const QueueImpl qbench_impls[] = {
+    { "ring", 0, 0, ring_create, ring_push, ring_reinsert, ring_pop, ring_print, ring_destroy },
+    { "sorted-ring", 1, 4096, ring_create, sorted_ring_push, sorted_ring_push, ring_pop, ring_print, ring_destroy },
+    { "heap", 1, 0, heap_create, heap_push_sorted, heap_push_sorted, heap_pop_min, heap_print, heap_destroy },
+    { "rbtree", 1, 0, tree_create, tree_push, tree_push, tree_pop, tree_print, tree_destroy },
+};
+#define QBENCH_IMPLS ((int)(sizeof(qbench_impls) / sizeof(qbench_impls[0])))
+
+// A scenario runs at least ops operations on a queue of depth processes, returning how many it ran.
+// Queues are filled before the timed rounds and drained after them as the scenario requires.
+typedef long long (*QueueScenario)(QueueBench *b, const QueueImpl *impl, int depth, long long ops);
+
+// Queue Benchmark Functions:
+// Prototypes:
+long long scenario_fifo_churn(QueueBench *b, const QueueImpl *impl, int depth, long long ops);
+long long scenario_preempt_reinsert(QueueBench *b, const QueueImpl *impl, int depth, long long ops);
+long long scenario_fill_drain(QueueBench *b, const QueueImpl *impl, int depth, long long ops);
+long long scenario_print(QueueBench *b, const QueueImpl *impl, int depth, long long ops);
+
+
+static int random_key(QueueBench *b) {
+    return 1 + (int)(rand48_next(&b->rng) * QBENCH_KEY_RANGE);
+}
+
+
+// Fill to depth with processes 0..depth-1, keyed in arrival order or at random
+static void qbench_fill(QueueBench *b, const QueueImpl *impl, int depth, int random) {
+    for (int i = 0; i < depth; i++) {
+        b->keys[i] = random ? random_key(b) : b->next_key++;
+        impl->push(b, &b->processes[i]);
+    }
+}
+
+
+static void qbench_drain(QueueBench *b, const QueueImpl *impl, int depth) {
+    for (int i = 0; i < depth; i++) {
+        impl->pop(b);
+    }
+}
+
+
+// FCFS/RR steady state: the front process leaves and one rejoins at the back
+long long scenario_fifo_churn(QueueBench *b, const QueueImpl *impl, int depth, long long ops) {
+    (void)depth;            // Every pop is matched by a push, so the queue stays at the depth it was filled to
+    long long done = 0;
+    for (; done < ops; done += 2) {
+        Process *process = impl->pop(b);
+        b->keys[process->id] = b->next_key++;
+        impl->push(b, process);
+    }
+    return done;
+}
+
+
+// SRT/RR_ALT preemption: the front process runs and goes back with a new key, or to the front of a FIFO
+long long scenario_preempt_reinsert(QueueBench *b, const QueueImpl *impl, int depth, long long ops) {
+    (void)depth;            // Every pop is matched by a push, so the queue stays at the depth it was filled to
+    long long done = 0;
+    for (; done < ops; done += 2) {
+        Process *process = impl->pop(b);
+        b->keys[process->id] = random_key(b);
+        impl->reinsert(b, process);
+    }
+    return done;
+}
+
+
+// A burst of arrivals building a deep queue, then emptying it
+long long scenario_fill_drain(QueueBench *b, const QueueImpl *impl, int depth, long long ops) {
+    long long done = 0;
+    do {
+        qbench_fill(b, impl, depth, impl->sorted);
+        qbench_drain(b, impl, depth);
+        done += 2LL * depth;
+    } while (done < ops);
+    return done;
+}
+
+
+// Ready queue printing in trace lines; one op per process printed
+long long scenario_print(QueueBench *b, const QueueImpl *impl, int depth, long long ops) {
+    long long done = 0;
+    do {
+        impl->print(b);
+        trace_flush(b->sink);
+        done += depth;
+    } while (done < ops);
+    return done;
+}
+
+
+#define QBENCH_EMPTY 0           // Scenario starts from an empty queue
+#define QBENCH_IN_ORDER 1        // Filled with keys in arrival order
+#define QBENCH_RANDOM 2          // Filled with random keys
+
+static const struct {
+    const char *name;
+    int fill;
+    QueueScenario run;
+} qbench_scenarios[] = {
+    { "fifo-churn", QBENCH_IN_ORDER, scenario_fifo_churn },
+    { "preempt-reinsert", QBENCH_RANDOM, scenario_preempt_reinsert },
+    { "fill-drain", QBENCH_EMPTY, scenario_fill_drain },
+    { "print", QBENCH_RANDOM, scenario_print },
+};
+#define QBENCH_SCENARIOS ((int)(sizeof(qbench_scenarios) / sizeof(qbench_scenarios[0])))
+
+
+// Hardware cache-miss counter for this thread, or -1 where perf events are not permitted
+static int open_cache_miss_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+// Whether name is one of the comma-separated names in list; every name is when list is NULL
+static int qbench_selected(const char *list, const char *name) {
+    if (list == NULL) {
+        return 1;
+    }
+    size_t length = strlen(name);
+    for (const char *at = list; at != NULL; at = strchr(at, ',')) {
+        at += (*at == ',');
+        if (strncmp(at, name, length) == 0 && (at[length] == ',' || at[length] == '\0')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static double qbench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+
+static void qbench_usage(const char *binary) {
+    fprintf(stderr, "Usage: %s [--rounds N] [--ops N] [--max-depth N] [--impls NAME,NAME,...]\n", binary);
+    exit(EXIT_FAILURE);
+}
+
+
+int main(int argc, char *argv[]) {
+    int rounds = QBENCH_DEFAULT_ROUNDS;
+    long long ops = QBENCH_DEFAULT_OPS;
+    int max_depth = QBENCH_DEFAULT_MAX_DEPTH;
+    const char *impls = NULL;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            qbench_usage(argv[0]);
+        }
+        char *end;
+        long long value = strtoll(argv[i + 1], &end, 10);
+        if (strcmp(argv[i], "--impls") == 0) {
+            impls = argv[i + 1];
+            continue;
+        }
+        if (end == argv[i + 1] || *end != '\0' || value <= 0 || value > INT_MAX) {
+            qbench_usage(argv[0]);
+        }
+        if (strcmp(argv[i], "--rounds") == 0) {
+            rounds = (int)value;
+        } else if (strcmp(argv[i], "--ops") == 0) {
+            ops = value;
+        } else if (strcmp(argv[i], "--max-depth") == 0) {
+            max_depth = (int)value;
+        } else {
+            qbench_usage(argv[0]);
+        }
+    }
+
+    int capacity = 0;
+    for (int d = 0; d < QBENCH_DEPTHS; d++) {
+        if (qbench_depths[d] <= max_depth && qbench_depths[d] > capacity) {
+            capacity = qbench_depths[d];
+        }
+    }
+    QueueBench b;
+    memset(&b, 0, sizeof(b));
+    b.processes = (Process *)calloc(capacity, sizeof(Process));
+    b.keys = (int *)malloc(capacity * sizeof(int));
+    b.sink = (TraceSink *)malloc(sizeof(TraceSink));
+    if (b.processes == NULL || b.keys == NULL || b.sink == NULL) {
+        fprintf(stderr, "Memory allocation failed for the queue benchmark\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < capacity; i++) {
+        b.processes[i].id = i;
+    }
+    trace_init(b.sink, open("/dev/null", O_WRONLY));
+    trace_set_processes(b.sink, b.processes);
+
+    int counter = open_cache_miss_counter();
+    printf("%-17s %8s  %-12s %10s %10s %14s\n", "scenario", "depth", "queue", "ns/op", "stddev", "cache miss/op");
+    for (int s = 0; s < QBENCH_SCENARIOS; s++) {
+        for (int d = 0; d < QBENCH_DEPTHS && qbench_depths[d] <= max_depth; d++) {
+            int depth = qbench_depths[d];
+            for (int q = 0; q < QBENCH_IMPLS; q++) {
+                const QueueImpl *impl = &qbench_impls[q];
+                if ((impl->max_depth > 0 && depth > impl->max_depth) ||
+                    !qbench_selected(impls, impl->name)) {
+                    continue;
+                }
+                impl->create(&b, depth);
+                rand48_seed(&b.rng, QBENCH_SEED);
+                b.next_key = 0;
+                if (qbench_scenarios[s].fill != QBENCH_EMPTY) {
+                    qbench_fill(&b, impl, depth, qbench_scenarios[s].fill == QBENCH_RANDOM);
+                }
+                qbench_scenarios[s].run(&b, impl, depth, ops);      // Warm-up round, not measured
+
+                // ns/op kept in picoseconds, as StatAccumulator takes integer samples
+                StatAccumulator ns_per_op;
+                memset(&ns_per_op, 0, sizeof(ns_per_op));
+                long long misses = 0, total_ops = 0;
+                for (int r = 0; r < rounds; r++) {
+                    if (counter >= 0) {
+                        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+                        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+                    }
+                    double start = qbench_now_ns();
+                    long long done = qbench_scenarios[s].run(&b, impl, depth, ops);
+                    double elapsed = qbench_now_ns() - start;
+                    if (counter >= 0) {
+                        long long count = 0;
+                        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+                        if (read(counter, &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+                            misses += count;
+                        }
+                    }
+                    stat_add(&ns_per_op, (long long)(elapsed / done * 1000));
+                    total_ops += done;
+                }
+                if (qbench_scenarios[s].fill != QBENCH_EMPTY) {
+                    qbench_drain(&b, impl, depth);
+                }
+                impl->destroy(&b);
+
+                printf("%-17s %8d  %-12s %10.2f %10.2f ", qbench_scenarios[s].name, depth, impl->name,
+                       stat_mean(&ns_per_op) / 1000, stat_stddev(&ns_per_op) / 1000);
+                if (counter >= 0) {
+                    printf("%14.3f\n", (double)misses / total_ops);
+                } else {
+                    printf("%14s\n", "n/a");
+                }
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (counter >= 0) {
+        close(counter);
+    }
+    trace_close(b.sink);
+    free(b.sink);
+    free(b.keys);
+    free(b.processes);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef RAND48_H
+#define RAND48_H
+
+#include <stdint.h>
+
+// The 48-bit linear congruential generator behind srand48/drand48:
+//   x' = (RAND48_A * x + RAND48_C) mod 2^48
+#define RAND48_A 0x5DEECE66DULL
+#define RAND48_C 0xBULL
+#define RAND48_MASK ((1ULL << 48) - 1)
+
+// Explicit generator state, so independent streams can run on different threads
+typedef struct {
+    uint64_t x;
+} Rand48;
+
+// Rand48 Functions:
+// Prototypes:
+void rand48_seed(Rand48 *rng, long seed);
+double rand48_next(Rand48 *rng);
+void rand48_skip(Rand48 *rng, uint64_t steps);
+
+// Same starting state as srand48(seed): the low 32 bits of seed above 0x330E
+void rand48_seed(Rand48 *rng, long seed) {
+    rng->x = ((uint64_t)(seed & 0xffffffffL) << 16) | 0x330E;
+}
+
+// Advance one step and return the state scaled to [0, 1); bit-identical to drand48()
+double rand48_next(Rand48 *rng) {
+    rng->x = (RAND48_A * rng->x + RAND48_C) & RAND48_MASK;
+    return (double)rng->x * 0x1p-48;
+}
+
+// Advance steps draws in O(log steps) by squaring the affine map x -> a*x + c
+void rand48_skip(Rand48 *rng, uint64_t steps) {
+    uint64_t a = RAND48_A, c = RAND48_C;   // Map for the current power of two steps
+    uint64_t total_a = 1, total_c = 0;      // Map accumulated so far
+    while (steps > 0) {
+        if (steps & 1) {
+            total_a = (total_a * a) & RAND48_MASK;
+            total_c = (total_c * a + c) & RAND48_MASK;
+        }
+        c = ((a + 1) * c) & RAND48_MASK;
+        a = (a * a) & RAND48_MASK;
+        steps >>= 1;
+    }
+    rng->x = (total_a * rng->x + total_c) & RAND48_MASK;
+}
+
+#endif // RAND48_H
@@ -0,0 +1,407 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "trace.h"
+#include "profile.h"
+#include "process.h"
+
+// Tree node for one process, stored at the process's index
+typedef struct {
+    long long key;          // Primary key: virtual runtime, burst estimate, remaining time or stride pass
+    int tau;                // Secondary key: current tau estimate, 0 when unused
+    int order;              // Final tie-break: insertion sequence by default, so equal keys leave in FIFO order
+    int left;
+    int right;
+    int parent;
+    unsigned char red;
+    unsigned char queued;   // The process is in the tree
+} TreeNode;
+
+// Red-black tree used as a ready queue ordered by (key, tau, order), with O(log n) insert and removal
+// and the minimum cached so the next process to run is found in constant time. An in-order walk
+// prints the queue without sorting it. Nodes live in
+// one array indexed by process, with a shared black sentinel in the last slot standing in for
+// every leaf.
+typedef struct {
+    TreeNode *nodes;        // capacity nodes plus the sentinel
+    Process *base;          // Process array the tree indexes into
+    int root;
+    int leftmost;           // Node with the smallest key, or nil
+    int nil;                // Sentinel index
+    int size;               // Current number of queued processes
+    int capacity;           // Maximum number of queued processes
+    int sequence;           // Insertion counter for FIFO tie-breaks
+} ReadyTree;
+
+// ReadyTree Functions:
+// Prototypes:
+ReadyTree* create_tree(Process *base, int capacity);
+void tree_insert(ReadyTree *tree, Process *process, long long key);
+void tree_insert_ordered(ReadyTree *tree, Process *process, long long key, int tau, int order);
+void tree_remove(ReadyTree *tree, Process *process);
+Process* tree_min(ReadyTree *tree);
+long long tree_min_key(ReadyTree *tree);
+Process* tree_pop_min(ReadyTree *tree);
+bool tree_is_empty(ReadyTree *tree);
+int tree_size(ReadyTree *tree);
+void print_tree(TraceSink *sink, ReadyTree *tree);
+void free_tree(ReadyTree *tree);
+
+// Initialize a tree able to hold every process in base[0..capacity)
+ReadyTree* create_tree(Process *base, int capacity) {
+    ReadyTree *tree = (ReadyTree*)malloc(sizeof(ReadyTree));
+    if (tree == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for tree\n");
+        exit(EXIT_FAILURE);
+    }
+    tree->nodes = (TreeNode*)calloc((size_t)capacity + 1, sizeof(TreeNode));
+    if (tree->nodes == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for tree nodes\n");
+        exit(EXIT_FAILURE);
+    }
+    tree->base = base;
+    tree->nil = capacity;
+    tree->root = tree->nil;
+    tree->leftmost = tree->nil;
+    tree->size = 0;
+    tree->capacity = capacity;
+    tree->sequence = 0;
+    TreeNode *nil = &tree->nodes[tree->nil];
+    nil->left = nil->right = nil->parent = tree->nil;
+    nil->red = 0;
+    return tree;
+}
+
+// Order of node a relative to node b
+static int tree_less(ReadyTree *tree, int a, int b) {
+    PROFILE_COUNT(queue_compares);
+    TreeNode *x = &tree->nodes[a];
+    TreeNode *y = &tree->nodes[b];
+    if (x->key != y->key) {
+        return x->key < y->key;
+    }
+    return (x->tau != y->tau) ? x->tau < y->tau : x->order < y->order;
+}
+
+static void tree_rotate_left(ReadyTree *tree, int x) {
+    TreeNode *nodes = tree->nodes;
+    int y = nodes[x].right;
+    nodes[x].right = nodes[y].left;
+    if (nodes[y].left != tree->nil) {
+        nodes[nodes[y].left].parent = x;
+    }
+    nodes[y].parent = nodes[x].parent;
+    if (nodes[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == nodes[nodes[x].parent].left) {
+        nodes[nodes[x].parent].left = y;
+    } else {
+        nodes[nodes[x].parent].right = y;
+    }
+    nodes[y].left = x;
+    nodes[x].parent = y;
+}
+
+static void tree_rotate_right(ReadyTree *tree, int x) {
+    TreeNode *nodes = tree->nodes;
+    int y = nodes[x].left;
+    nodes[x].left = nodes[y].right;
+    if (nodes[y].right != tree->nil) {
+        nodes[nodes[y].right].parent = x;
+    }
+    nodes[y].parent = nodes[x].parent;
+    if (nodes[x].parent == tree->nil) {
+        tree->root = y;
+    } else if (x == nodes[nodes[x].parent].right) {
+        nodes[nodes[x].parent].right = y;
+    } else {
+        nodes[nodes[x].parent].left = y;
+    }
+    nodes[y].right = x;
+    nodes[x].parent = y;
+}
+
+static int tree_first(ReadyTree *tree, int x) {
+    while (tree->nodes[x].left != tree->nil) {
+        x = tree->nodes[x].left;
+    }
+    return x;
+}
+
+// In-order successor of x, or nil
+static int tree_next(ReadyTree *tree, int x) {
+    TreeNode *nodes = tree->nodes;
+    if (nodes[x].right != tree->nil) {
+        return tree_first(tree, nodes[x].right);
+    }
+    int parent = nodes[x].parent;
+    while (parent != tree->nil && x == nodes[parent].right) {
+        x = parent;
+        parent = nodes[parent].parent;
+    }
+    return parent;
+}
+
+// Add a Process with the given key; it goes after every queued process with an equal key
+void tree_insert(ReadyTree *tree, Process *process, long long key) {
+    tree_insert_ordered(tree, process, key, 0, tree->sequence++);
+}
+
+// Add a Process with explicit secondary keys; order must differ from every queued process's
+void tree_insert_ordered(ReadyTree *tree, Process *process, long long key, int tau, int order) {
+    TreeNode *nodes = tree->nodes;
+    int z = process - tree->base;
+    if (nodes[z].queued) {
+        trace_flush(&trace_stdout);
+        char id[PROCESS_NAME_MAX];
+        format_process_id(process->id, id);
+        fprintf(stderr, "Process %s is already in the tree\n", id);
+        exit(EXIT_FAILURE);
+    }
+    PROFILE_COUNT(queue_inserts);
+    nodes[z].key = key;
+    nodes[z].tau = tau;
+    nodes[z].order = order;
+    nodes[z].left = nodes[z].right = tree->nil;
+    nodes[z].red = 1;
+    nodes[z].queued = 1;
+
+    int parent = tree->nil;
+    int x = tree->root;
+    int leftmost = 1;
+    while (x != tree->nil) {
+        parent = x;
+        if (tree_less(tree, z, x)) {
+            x = nodes[x].left;
+        } else {
+            x = nodes[x].right;
+            leftmost = 0;
+        }
+    }
+    nodes[z].parent = parent;
+    if (parent == tree->nil) {
+        tree->root = z;
+    } else if (tree_less(tree, z, parent)) {
+        nodes[parent].left = z;
+    } else {
+        nodes[parent].right = z;
+    }
+    if (leftmost) {
+        tree->leftmost = z;
+    }
+    tree->size++;
+
+    while (nodes[nodes[z].parent].red) {
+        int p = nodes[z].parent;
+        int g = nodes[p].parent;
+        if (p == nodes[g].left) {
+            int uncle = nodes[g].right;
+            if (nodes[uncle].red) {
+                nodes[p].red = 0;
+                nodes[uncle].red = 0;
+                nodes[g].red = 1;
+                z = g;
+            } else {
+                if (z == nodes[p].right) {
+                    z = p;
+                    tree_rotate_left(tree, z);
+                    p = nodes[z].parent;
+                    g = nodes[p].parent;
+                }
+                nodes[p].red = 0;
+                nodes[g].red = 1;
+                tree_rotate_right(tree, g);
+            }
+        } else {
+            int uncle = nodes[g].left;
+            if (nodes[uncle].red) {
+                nodes[p].red = 0;
+                nodes[uncle].red = 0;
+                nodes[g].red = 1;
+                z = g;
+            } else {
+                if (z == nodes[p].left) {
+                    z = p;
+                    tree_rotate_right(tree, z);
+                    p = nodes[z].parent;
+                    g = nodes[p].parent;
+                }
+                nodes[p].red = 0;
+                nodes[g].red = 1;
+                tree_rotate_left(tree, g);
+            }
+        }
+    }
+    nodes[tree->root].red = 0;
+}
+
+// Put subtree v where subtree u was
+static void tree_transplant(ReadyTree *tree, int u, int v) {
+    TreeNode *nodes = tree->nodes;
+    if (nodes[u].parent == tree->nil) {
+        tree->root = v;
+    } else if (u == nodes[nodes[u].parent].left) {
+        nodes[nodes[u].parent].left = v;
+    } else {
+        nodes[nodes[u].parent].right = v;
+    }
+    nodes[v].parent = nodes[u].parent;
+}
+
+// Remove a queued Process
+void tree_remove(ReadyTree *tree, Process *process) {
+    TreeNode *nodes = tree->nodes;
+    int z = process - tree->base;
+    if (!nodes[z].queued) {
+        trace_flush(&trace_stdout);
+        char id[PROCESS_NAME_MAX];
+        format_process_id(process->id, id);
+        fprintf(stderr, "Process %s is not in the tree\n", id);
+        exit(EXIT_FAILURE);
+    }
+    if (z == tree->leftmost) {
+        tree->leftmost = tree_next(tree, z);
+    }
+
+    int y = z;
+    int y_was_red = nodes[y].red;
+    int x;
+    if (nodes[z].left == tree->nil) {
+        x = nodes[z].right;
+        tree_transplant(tree, z, x);
+    } else if (nodes[z].right == tree->nil) {
+        x = nodes[z].left;
+        tree_transplant(tree, z, x);
+    } else {
+        y = tree_first(tree, nodes[z].right);
+        y_was_red = nodes[y].red;
+        x = nodes[y].right;
+        if (nodes[y].parent == z) {
+            nodes[x].parent = y;
+        } else {
+            tree_transplant(tree, y, x);
+            nodes[y].right = nodes[z].right;
+            nodes[nodes[y].right].parent = y;
+        }
+        tree_transplant(tree, z, y);
+        nodes[y].left = nodes[z].left;
+        nodes[nodes[y].left].parent = y;
+        nodes[y].red = nodes[z].red;
+    }
+    nodes[z].queued = 0;
+    tree->size--;
+
+    if (y_was_red) {
+        nodes[tree->nil].parent = tree->nil;
+        return;
+    }
+    while (x != tree->root && !nodes[x].red) {
+        int p = nodes[x].parent;
+        if (x == nodes[p].left) {
+            int w = nodes[p].right;
+            if (nodes[w].red) {
+                nodes[w].red = 0;
+                nodes[p].red = 1;
+                tree_rotate_left(tree, p);
+                w = nodes[p].right;
+            }
+            if (!nodes[nodes[w].left].red && !nodes[nodes[w].right].red) {
+                nodes[w].red = 1;
+                x = p;
+            } else {
+                if (!nodes[nodes[w].right].red) {
+                    nodes[nodes[w].left].red = 0;
+                    nodes[w].red = 1;
+                    tree_rotate_right(tree, w);
+                    w = nodes[p].right;
+                }
+                nodes[w].red = nodes[p].red;
+                nodes[p].red = 0;
+                nodes[nodes[w].right].red = 0;
+                tree_rotate_left(tree, p);
+                x = tree->root;
+            }
+        } else {
+            int w = nodes[p].left;
+            if (nodes[w].red) {
+                nodes[w].red = 0;
+                nodes[p].red = 1;
+                tree_rotate_right(tree, p);
+                w = nodes[p].left;
+            }
+            if (!nodes[nodes[w].right].red && !nodes[nodes[w].left].red) {
+                nodes[w].red = 1;
+                x = p;
+            } else {
+                if (!nodes[nodes[w].left].red) {
+                    nodes[nodes[w].right].red = 0;
+                    nodes[w].red = 1;
+                    tree_rotate_left(tree, w);
+                    w = nodes[p].left;
+                }
+                nodes[w].red = nodes[p].red;
+                nodes[p].red = 0;
+                nodes[nodes[w].left].red = 0;
+                tree_rotate_right(tree, p);
+                x = tree->root;
+            }
+        }
+    }
+    nodes[x].red = 0;
+    // Deletion fix-up may have parked a parent on the sentinel
+    nodes[tree->nil].parent = tree->nil;
+}
+
+// The queued Process with the smallest key, or NULL when the tree is empty
+Process* tree_min(ReadyTree *tree) {
+    return tree->size == 0 ? NULL : &tree->base[tree->leftmost];
+}
+
+// Smallest queued key; the tree must not be empty
+long long tree_min_key(ReadyTree *tree) {
+    return tree->nodes[tree->leftmost].key;
+}
+
+// Remove and return the Process with the smallest key
+Process* tree_pop_min(ReadyTree *tree) {
+    if (tree->size == 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Tree is empty, cannot pop\n");
+        exit(EXIT_FAILURE);
+    }
+    Process *process = &tree->base[tree->leftmost];
+    tree_remove(tree, process);
+    return process;
+}
+
+bool tree_is_empty(ReadyTree *tree) {
+    return tree->size == 0;
+}
+
+int tree_size(ReadyTree *tree) {
+    return tree->size;
+}
+
+// Print the queued processes in key order
+void print_tree(TraceSink *sink, ReadyTree *tree) {
+    if (sink->discard) {
+        return;
+    }
+    trace_queue_begin(sink);
+    for (int x = tree->leftmost; x != tree->nil && tree->size > 0; x = tree_next(tree, x)) {
+        trace_queue_item(sink, &tree->base[x]);
+    }
+    trace_queue_end(sink);
+}
+
+void free_tree(ReadyTree *tree) {
+    free(tree->nodes);
+    free(tree);
+}
+
+#endif // RBTREE_H
@@ -0,0 +1,289 @@
+#ifndef SIM_CFS_H
+#define SIM_CFS_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "rbtree.h"
+#include "process.h"
+#include "engine.h"
+#include "stats.h"
+#include "context.h"
+
+#define CFS_DEFAULT_LATENCY 240
+#define CFS_DEFAULT_GRANULARITY 30
+#define CFS_NICE_0_WEIGHT 1024      // Weight whose virtual runtime advances at wall-clock rate
+#define CFS_MAX_WEIGHT 1048576
+
+// Fair scheduler settings from the command line
+typedef struct {
+    int enabled;            // Run CFS after the other policies
+    int target_latency;     // ms
+    int min_granularity;    // ms
+    int weights[2];         // Indexed by is_cpu_bound
+} CfsConfig;
+
+// CFS Functions:
+// Prototypes:
+void cfs_default_config(CfsConfig *config);
+int parse_cfs_flag(int argc, char *argv[], int *i, CfsConfig *config);
+int cfs_finish_config(CfsConfig *config);
+SimStats simulate_cfs(const SimContext *ctx, int tcs, const CfsConfig *config);
+
+
+void cfs_default_config(CfsConfig *config) {
+    config->enabled = 0;
+    config->target_latency = CFS_DEFAULT_LATENCY;
+    config->min_granularity = CFS_DEFAULT_GRANULARITY;
+    config->weights[0] = config->weights[1] = CFS_NICE_0_WEIGHT;
+}
+
+
+// Parse a positive integer no larger than max, followed by terminator
+static int cfs_parse_int(const char *text, char **end, int max, int *value) {
+    long parsed = strtol(text, end, 10);
+    if (*end == text || parsed <= 0 || parsed > max) {
+        return 0;
+    }
+    *value = (int)parsed;
+    return 1;
+}
+
+
+// Parse the CFS flag at argv[*i], if it is one, advancing *i past its value. Returns 1 when the
+// flag was consumed, 0 when argv[*i] is not a CFS flag, and -1 when its value is invalid.
+// Any CFS flag enables the policy.
+int parse_cfs_flag(int argc, char *argv[], int *i, CfsConfig *config) {
+    const char *flag = argv[*i];
+    if (strcmp(flag, "--cfs") == 0) {
+        config->enabled = 1;
+        return 1;
+    }
+    if (strcmp(flag, "--cfs-latency") != 0 && strcmp(flag, "--cfs-granularity") != 0 && strcmp(flag, "--cfs-weights") != 0) {
+        return 0;
+    }
+    if (*i + 1 >= argc) {
+        return -1;
+    }
+    const char *value = argv[++*i];
+    char *end;
+    config->enabled = 1;
+
+    if (strcmp(flag, "--cfs-latency") == 0) {
+        if (!cfs_parse_int(value, &end, INT_MAX, &config->target_latency) || *end != '\0') {
+            return -1;
+        }
+    } else if (strcmp(flag, "--cfs-granularity") == 0) {
+        if (!cfs_parse_int(value, &end, INT_MAX, &config->min_granularity) || *end != '\0') {
+            return -1;
+        }
+    } else {
+        // CPU-bound weight first, then I/O-bound
+        if (!cfs_parse_int(value, &end, CFS_MAX_WEIGHT, &config->weights[1]) || *end != ',' ||
+            !cfs_parse_int(end + 1, &end, CFS_MAX_WEIGHT, &config->weights[0]) || *end != '\0') {
+            return -1;
+        }
+    }
+    return 1;
+}
+
+
+// Check the settings once every flag has been parsed; returns 0 if the latency is below the granularity
+int cfs_finish_config(CfsConfig *config) {
+    return config->min_granularity <= config->target_latency;
+}
+
+
+static int cfs_weight(Engine *e, int pid) {
+    return e->params->weights[e->processes[pid].is_cpu_bound ? 1 : 0];
+}
+
+
+// Virtual runtimes are kept in weighted microseconds so light weights do not round to nothing
+static long long cfs_scaled(Engine *e, int pid, long long ms) {
+    return ms * 1000 * CFS_NICE_0_WEIGHT / cfs_weight(e, pid);
+}
+
+
+// Virtual runtime in ms for trace lines
+static int cfs_vruntime_ms(Engine *e, int pid) {
+    long long ms = e->vruntime[pid] / 1000;
+    return ms > INT_MAX ? INT_MAX : (int)ms;
+}
+
+
+// Virtual runtime of the running process including the time it has run but not yet been charged
+static long long cfs_current_vruntime(Engine *e, int pid) {
+    long long ran = e->current_time - e->charged_since[pid];
+    return e->vruntime[pid] + (ran > 0 ? cfs_scaled(e, pid, ran) : 0);
+}
+
+
+// min_vruntime only moves forward, tracking the smaller of the running and the leftmost process
+static void cfs_update_min_vruntime(Engine *e) {
+    long long floor = LLONG_MAX;
+    if (e->cpu_process != NULL) {
+        floor = e->vruntime[e->cpu_process - e->processes];
+    }
+    if (!tree_is_empty(e->tree) && tree_min_key(e->tree) < floor) {
+        floor = tree_min_key(e->tree);
+    }
+    if (floor != LLONG_MAX && floor > e->min_vruntime) {
+        e->min_vruntime = floor;
+    }
+}
+
+
+static void cfs_enqueue(Engine *e, int pid) {
+    tree_insert(e->tree, &e->processes[pid], e->vruntime[pid]);
+    e->ready_weight += cfs_weight(e, pid);
+}
+
+
+// The process's share of the scheduling period, which stretches once min_granularity per
+// runnable process no longer fits in the target latency; never shorter than min_granularity
+static int cfs_slice(Engine *e, int pid) {
+    const SchedParams *params = e->params;
+    long long runnable = tree_size(e->tree) + 1;
+    long long period = params->target_latency;
+    if (runnable * params->min_granularity > period) {
+        period = runnable * params->min_granularity;
+    }
+    long long weight = cfs_weight(e, pid);
+    long long slice = period * weight / (e->ready_weight + weight);
+    if (slice < params->min_granularity) {
+        slice = params->min_granularity;
+    }
+    return (e->remaining_time[pid] > slice) ? (int)slice : e->remaining_time[pid];
+}
+
+
+// New arrivals start at min_vruntime; processes back from I/O keep their virtual runtime but
+// get at most half a target latency of credit for the time they slept. Either preempts the
+// running process when it is ahead by more than min_granularity.
+static void cfs_admit(Engine *e, int pid, int from_io) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    e->burst_length[pid] = e->remaining_time[pid] = cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    cfs_update_min_vruntime(e);
+    long long floor = from_io ? e->min_vruntime - (long long)e->params->target_latency * 1000 / 2 : e->min_vruntime;
+    if (e->vruntime[pid] < floor) {
+        e->vruntime[pid] = floor;
+    }
+    cfs_enqueue(e, pid);
+
+    Process *cpu_process = e->cpu_process;
+    int running = (cpu_process != NULL) ? (int)(cpu_process - e->processes) : -1;
+    // A run ending now is handled by the engine straight after admissions
+    if (running != -1 && now < e->cpu_burst_end_time &&
+        e->vruntime[pid] + (long long)e->params->min_granularity * 1000 < cfs_current_vruntime(e, running)) {
+        // Charge what ran and give back what did not; a process still switching in has not run
+        long long ran_from = (e->charged_since[running] > now) ? e->charged_since[running] : now;
+        e->vruntime[running] += cfs_scaled(e, running, ran_from - e->charged_since[running]);
+        e->remaining_time[running] += e->cpu_burst_end_time - ran_from;
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Process %P (vruntime %dms) %s; preempting %P (vruntime %dms) ", now, process,
+                         cfs_vruntime_ms(e, pid), from_io ? "completed I/O" : "arrived", cpu_process, cfs_vruntime_ms(e, running));
+            print_tree(e->trace, e->tree);
+        }
+        cfs_enqueue(e, running);
+        e->preemptions[cpu_process->is_cpu_bound ? 1 : 0]++;
+        engine_preempt_running(e);
+        return;
+    }
+
+    if (now < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (vruntime %dms) %s; added to ready queue ", now, process,
+                     cfs_vruntime_ms(e, pid), from_io ? "completed I/O" : "arrived");
+        print_tree(e->trace, e->tree);
+    }
+}
+
+
+// End of a slice: charge it, then finish the burst, hand the CPU to a process with a smaller
+// virtual runtime, or start another slice in place
+static int cfs_run_stopped(Engine *e, int pid) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    e->vruntime[pid] += cfs_scaled(e, pid, now - e->charged_since[pid]);
+    e->charged_since[pid] = now;
+    cfs_update_min_vruntime(e);
+    if (e->remaining_time[pid] == 0) {
+        return RUN_FINISHED;
+    }
+
+    if (!tree_is_empty(e->tree) && tree_min_key(e->tree) < e->vruntime[pid]) {
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Time slice expired; preempting process %P (vruntime %dms) with %dms remaining ",
+                         now, process, cfs_vruntime_ms(e, pid), e->remaining_time[pid]);
+            print_tree(e->trace, e->tree);
+        }
+        cfs_enqueue(e, pid);
+        e->preemptions[process->is_cpu_bound ? 1 : 0]++;
+        return RUN_PREEMPTED;
+    }
+
+    if (now < 10000) {
+        trace_printf(e->trace, "time %lldms: Time slice expired; no preemption because no process has a smaller vruntime ", now);
+        print_tree(e->trace, e->tree);
+    }
+    int slice = cfs_slice(e, pid);
+    e->cpu_burst_end_time = now + slice;
+    e->remaining_time[pid] -= slice;
+    e->cpu_idle_until = now;
+    return RUN_CONTINUES;
+}
+
+
+static void cfs_burst_completed(Engine *e, int pid, int bursts_left) {
+    if (bursts_left > 0 && e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (vruntime %dms) completed a CPU burst; %d burst%s to go ",
+                     e->current_time, &e->processes[pid], cfs_vruntime_ms(e, pid), bursts_left, bursts_left == 1 ? "" : "s");
+        print_tree(e->trace, e->tree);
+    }
+}
+
+
+static int cfs_start_run(Engine *e, int pid, long long start_time) {
+    e->ready_weight -= cfs_weight(e, pid);
+    int slice = cfs_slice(e, pid);
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (vruntime %dms) started using the CPU for ", start_time, &e->processes[pid], cfs_vruntime_ms(e, pid));
+        if (e->remaining_time[pid] != e->burst_length[pid]) {
+            trace_printf(e->trace, "remaining %dms of %dms burst ", e->remaining_time[pid], e->burst_length[pid]);
+        } else {
+            trace_printf(e->trace, "%dms burst ", e->burst_length[pid]);
+        }
+        print_tree(e->trace, e->tree);
+    }
+    e->remaining_time[pid] -= slice;
+    e->charged_since[pid] = start_time;
+    return slice;
+}
+
+
+static void cfs_ended(Engine *e) {
+    trace_printf(e->trace, "time %lldms: Simulator ended for CFS [Q empty]\n\n", e->current_time + 1);
+}
+
+
+static const SchedPolicy cfs_policy = {
+    .name = "CFS",
+    .ready = READY_TREE,
+    .delayed_start = 0,
+    .admit = cfs_admit,
+    .run_stopped = cfs_run_stopped,
+    .burst_completed = cfs_burst_completed,
+    .start_run = cfs_start_run,
+    .ended = cfs_ended,
+    .summarize = engine_summarize,
+};
+
+SimStats simulate_cfs(const SimContext *ctx, int tcs, const CfsConfig *config) {
+    SchedParams params = { .tcs = tcs, .target_latency = config->target_latency,
+                           .min_granularity = config->min_granularity, .weights = config->weights };
+    return run_scheduler(ctx, &params, &cfs_policy);
+}
+
+#endif // SIM_CFS_H
@@ -0,0 +1,322 @@
+#ifndef SIM_MLFQ_H
+#define SIM_MLFQ_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "levels.h"
+#include "process.h"
+#include "engine.h"
+#include "stats.h"
+#include "context.h"
+
+#define MLFQ_DEFAULT_LEVELS 3
+#define MLFQ_DEFAULT_BOOST 1000
+
+// Multilevel feedback queue settings from the command line
+typedef struct {
+    int enabled;            // Run MLFQ after the other policies
+    int levels;             // 0 until set: one per explicit quantum, or MLFQ_DEFAULT_LEVELS
+    int n_quanta;           // Quanta given explicitly; 0 derives them from the RR time slice
+    int quanta[MAX_LEVELS];
+    int boost_period;       // Interval between priority boosts (ms); 0 never boosts
+} MlfqConfig;
+
+// MLFQ Functions:
+// Prototypes:
+void mlfq_default_config(MlfqConfig *config);
+int parse_mlfq_flag(int argc, char *argv[], int *i, MlfqConfig *config);
+int mlfq_finish_config(MlfqConfig *config);
+SimStats simulate_mlfq(const SimContext *ctx, int tcs, int t_slice, const MlfqConfig *config);
+
+
+void mlfq_default_config(MlfqConfig *config) {
+    config->enabled = 0;
+    config->levels = 0;
+    config->n_quanta = 0;
+    config->boost_period = MLFQ_DEFAULT_BOOST;
+}
+
+
+// Parse the MLFQ flag at argv[*i], if it is one, advancing *i past its value. Returns 1 when the
+// flag was consumed, 0 when argv[*i] is not an MLFQ flag, and -1 when its value is invalid.
+// Any MLFQ flag enables the policy.
+int parse_mlfq_flag(int argc, char *argv[], int *i, MlfqConfig *config) {
+    const char *flag = argv[*i];
+    if (strcmp(flag, "--mlfq") == 0) {
+        config->enabled = 1;
+        return 1;
+    }
+    if (strcmp(flag, "--mlfq-levels") != 0 && strcmp(flag, "--mlfq-quanta") != 0 && strcmp(flag, "--mlfq-boost") != 0) {
+        return 0;
+    }
+    if (*i + 1 >= argc) {
+        return -1;
+    }
+    const char *value = argv[++*i];
+    char *end;
+    config->enabled = 1;
+
+    if (strcmp(flag, "--mlfq-levels") == 0) {
+        long levels = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || levels < 1 || levels > MAX_LEVELS) {
+            return -1;
+        }
+        config->levels = (int)levels;
+    } else if (strcmp(flag, "--mlfq-quanta") == 0) {
+        // Comma-separated, highest priority level first
+        config->n_quanta = 0;
+        do {
+            long quantum = strtol(value, &end, 10);
+            if (end == value || quantum <= 0 || quantum > INT_MAX || config->n_quanta == MAX_LEVELS) {
+                return -1;
+            }
+            config->quanta[config->n_quanta++] = (int)quantum;
+            value = end + 1;
+        } while (*end == ',');
+        if (*end != '\0') {
+            return -1;
+        }
+    } else {
+        long boost = strtol(value, &end, 10);
+        if (end == value || *end != '\0' || boost < 0 || boost > INT_MAX) {
+            return -1;
+        }
+        config->boost_period = (int)boost;
+    }
+    return 1;
+}
+
+
+// Fill in the level count once every flag has been parsed; returns 0 if there are more quanta than levels
+int mlfq_finish_config(MlfqConfig *config) {
+    if (config->levels == 0) {
+        config->levels = config->n_quanta ? config->n_quanta : MLFQ_DEFAULT_LEVELS;
+    }
+    return config->n_quanta <= config->levels;
+}
+
+
+// Time a process gets at its level before it is demoted
+static int mlfq_quantum(Engine *e, int pid) {
+    return e->params->quanta[e->level[pid]];
+}
+
+
+// Length of the next run: the rest of the burst or the rest of the quantum, whichever is shorter
+static int mlfq_run(Engine *e, int pid) {
+    int quantum_left = mlfq_quantum(e, pid) - e->level_used[pid];
+    return (e->remaining_time[pid] > quantum_left) ? quantum_left : e->remaining_time[pid];
+}
+
+
+// Apply the boosts a process missed while it was not running: the boost itself only resets
+// the running process, so it costs nothing for the processes that are waiting or blocked
+static void mlfq_sync(Engine *e, int pid) {
+    if (e->level_epoch[pid] != e->boosts) {
+        e->level_epoch[pid] = e->boosts;
+        e->level[pid] = 0;
+        e->level_used[pid] = 0;
+    }
+}
+
+
+static void mlfq_enqueue(Engine *e, int pid) {
+    levels_push(e->levels, e->level[pid], &e->processes[pid]);
+}
+
+
+// Cut the running process's scheduled run short at now: charge what ran to its level and give
+// back what did not. Returns when its CPU time resumes, after now while it is still switching in.
+static long long mlfq_stop_run(Engine *e, int pid) {
+    long long now = e->current_time;
+    long long ran_from = (e->charged_since[pid] > now) ? e->charged_since[pid] : now;
+    e->level_used[pid] += ran_from - e->charged_since[pid];
+    e->remaining_time[pid] += e->cpu_burst_end_time - ran_from;
+    return ran_from;
+}
+
+
+// Periodic priority boost: every process, wherever it is, starts over at level 0 with a fresh quantum.
+// A running process boosted from a lower level has its run cut to the level 0 quantum.
+static long long mlfq_tick(Engine *e) {
+    int period = e->params->boost_period;
+    long long now = e->current_time;
+    if (period <= 0) {
+        return NO_EVENT;
+    }
+
+    if (now > 0 && now % period == 0) {
+        e->boosts++;
+        if (e->cpu_process != NULL) {
+            int pid = e->cpu_process - e->processes;
+            // A run ending now is handled by the engine straight after the tick
+            if (e->level[pid] > 0 && now < e->cpu_burst_end_time) {
+                long long resume = mlfq_stop_run(e, pid);
+                mlfq_sync(e, pid);
+                int run = mlfq_run(e, pid);
+                e->cpu_burst_end_time = resume + run;
+                e->remaining_time[pid] -= run;
+                e->charged_since[pid] = resume;
+            } else {
+                mlfq_sync(e, pid);
+                if (e->charged_since[pid] < now) {
+                    e->charged_since[pid] = now;
+                }
+            }
+        }
+        levels_merge_to_top(e->levels);
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Priority boost; all processes moved to level 0 ", now);
+            print_levels(e->trace, e->levels);
+        }
+    }
+
+    return (now / period + 1) * period;
+}
+
+
+// New arrivals start at level 0; processes back from I/O keep their level and what they have used
+// of its quantum. Either preempts a running process of strictly lower priority.
+static void mlfq_admit(Engine *e, int pid, int from_io) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    e->burst_length[pid] = e->remaining_time[pid] = cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    mlfq_sync(e, pid);
+    mlfq_enqueue(e, pid);
+
+    Process *cpu_process = e->cpu_process;
+    int running = (cpu_process != NULL) ? (int)(cpu_process - e->processes) : -1;
+    // A run ending now is handled by the engine straight after admissions
+    if (running != -1 && now < e->cpu_burst_end_time && e->level[pid] < e->level[running]) {
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Process %P (level %d) %s; preempting %P (level %d) ", now, process,
+                         e->level[pid], from_io ? "completed I/O" : "arrived", cpu_process, e->level[running]);
+            print_levels(e->trace, e->levels);
+        }
+        mlfq_stop_run(e, running);
+        mlfq_enqueue(e, running);
+        e->preemptions[cpu_process->is_cpu_bound ? 1 : 0]++;
+        engine_preempt_running(e);
+        return;
+    }
+
+    if (now < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (level %d) %s; added to ready queue ", now, process,
+                     e->level[pid], from_io ? "completed I/O" : "arrived");
+        print_levels(e->trace, e->levels);
+    }
+}
+
+
+// End of a run: charge it to the level and demote the process once its quantum is used up. Then
+// either finish the burst, preempt a demoted process if anything of equal or higher priority is
+// waiting, or keep going in place.
+static int mlfq_run_stopped(Engine *e, int pid) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    e->level_used[pid] += now - e->charged_since[pid];
+    int expired = e->level_used[pid] >= mlfq_quantum(e, pid);
+    if (expired) {
+        if (e->level[pid] < e->params->levels - 1) {
+            e->level[pid]++;
+        }
+        e->level_used[pid] = 0;
+    }
+    if (e->remaining_time[pid] == 0) {
+        return RUN_FINISHED;
+    }
+
+    if (expired) {
+        if (levels_top(e->levels) <= e->level[pid]) {
+            if (now < 10000) {
+                trace_printf(e->trace, "time %lldms: Time slice expired; preempting process %P with %dms remaining; now at level %d ",
+                             now, process, e->remaining_time[pid], e->level[pid]);
+                print_levels(e->trace, e->levels);
+            }
+            mlfq_enqueue(e, pid);
+            e->preemptions[process->is_cpu_bound ? 1 : 0]++;
+            return RUN_PREEMPTED;
+        }
+
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Time slice expired; process %P now at level %d; no preemption because no process of equal or higher priority is ready ",
+                         now, process, e->level[pid]);
+            print_levels(e->trace, e->levels);
+        }
+    }
+
+    int run = mlfq_run(e, pid);
+    e->cpu_burst_end_time = now + run;
+    e->remaining_time[pid] -= run;
+    e->charged_since[pid] = now;
+    e->cpu_idle_until = now;
+    return RUN_CONTINUES;
+}
+
+
+static void mlfq_burst_completed(Engine *e, int pid, int bursts_left) {
+    if (bursts_left > 0 && e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (level %d) completed a CPU burst; %d burst%s to go ",
+                     e->current_time, &e->processes[pid], e->level[pid], bursts_left, bursts_left == 1 ? "" : "s");
+        print_levels(e->trace, e->levels);
+    }
+}
+
+
+static int mlfq_start_run(Engine *e, int pid, long long start_time) {
+    mlfq_sync(e, pid);
+    int run = mlfq_run(e, pid);
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (level %d) started using the CPU for ", start_time, &e->processes[pid], e->level[pid]);
+        if (e->remaining_time[pid] != e->burst_length[pid]) {
+            trace_printf(e->trace, "remaining %dms of %dms burst ", e->remaining_time[pid], e->burst_length[pid]);
+        } else {
+            trace_printf(e->trace, "%dms burst ", e->burst_length[pid]);
+        }
+        print_levels(e->trace, e->levels);
+    }
+    e->remaining_time[pid] -= run;
+    e->charged_since[pid] = start_time;
+    return run;
+}
+
+
+static void mlfq_ended(Engine *e) {
+    trace_printf(e->trace, "time %lldms: Simulator ended for MLFQ [Q empty]\n\n", e->current_time + 1);
+}
+
+
+static const SchedPolicy mlfq_policy = {
+    .name = "MLFQ",
+    .ready = READY_LEVELS,
+    .delayed_start = 0,
+    .tick = mlfq_tick,
+    .admit = mlfq_admit,
+    .run_stopped = mlfq_run_stopped,
+    .burst_completed = mlfq_burst_completed,
+    .start_run = mlfq_start_run,
+    .ended = mlfq_ended,
+    .summarize = engine_summarize,
+};
+
+// Levels without an explicit quantum double the one above, starting from the RR time slice
+SimStats simulate_mlfq(const SimContext *ctx, int tcs, int t_slice, const MlfqConfig *config) {
+    int quanta[MAX_LEVELS];
+    for (int level = 0; level < config->levels; level++) {
+        if (level < config->n_quanta) {
+            quanta[level] = config->quanta[level];
+        } else if (level == 0) {
+            quanta[level] = t_slice;
+        } else {
+            quanta[level] = (quanta[level - 1] > INT_MAX / 2) ? INT_MAX : quanta[level - 1] * 2;
+        }
+    }
+
+    SchedParams params = { .tcs = tcs, .t_slice = t_slice, .levels = config->levels, .quanta = quanta,
+                           .boost_period = config->boost_period };
+    return run_scheduler(ctx, &params, &mlfq_policy);
+}
+
+#endif // SIM_MLFQ_H
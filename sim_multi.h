@@ -0,0 +1,603 @@
+#ifndef SIM_MULTI_H
+#define SIM_MULTI_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "profile.h"
+#include "process.h"
+#include "timer.h"
+#include "event.h"
+#include "bursts.h"
+#include "stats.h"
+#include "context.h"
+
+// Scheduling policies the multi-CPU engine can run
+#define MULTI_FCFS 0
+#define MULTI_SJF 1
+#define MULTI_SRT 2
+#define MULTI_RR 3
+
+// Core states
+#define CORE_IDLE 0
+#define CORE_LOADING 1      // Switching a process in (tcs / 2)
+#define CORE_RUNNING 2
+#define CORE_UNLOADING 3    // Switching a process out (tcs / 2)
+
+// Configuration for one multi-CPU run
+typedef struct {
+    int policy;             // MULTI_FCFS, MULTI_SJF, MULTI_SRT or MULTI_RR
+    int n_cpus;
+    int per_core_queues;    // 1: one ready queue per core with work stealing; 0: one global queue
+    int tcs;
+    double alpha;           // SJF/SRT estimate weight, or negative to use actual burst times
+    double lambda;          // Initial estimate is ceil(1 / lambda)
+    int t_slice;            // RR only
+    int rr_alt;             // RR only: preempted processes go to the front of the queue
+} MultiConfig;
+
+// What each core did during a run
+typedef struct {
+    long long busy_time;    // Time spent running bursts
+    int dispatches;         // Processes switched in
+    int steals;             // Processes taken from another core's queue
+} CoreStats;
+
+// Per-run totals beyond SimStats
+typedef struct {
+    int n_cpus;
+    int per_core_queues;
+    long long end_time;
+    int migrations;         // Dispatches onto a different core than the process last ran on
+    int steals;
+    CoreStats *cores;       // n_cpus entries, owned by the caller of simulate_multi
+} MultiStats;
+
+// Ready queue entry; lower (key, seq) runs first
+typedef struct {
+    int key;
+    int seq;
+    int pid;
+} RunEntry;
+
+// Growable binary min-heap used for both the global and the per-core ready queues
+typedef struct {
+    RunEntry *entries;
+    int size;
+    int capacity;
+} RunQueue;
+
+// Core event heap: the next state change of every busy core, ordered by (time, core)
+typedef struct {
+    int *heap;              // Core numbers
+    int *position;          // Index of each core in heap, or -1
+    long long *time;        // Event time of each core
+    int size;
+} CoreEvents;
+
+// Multi-CPU Functions:
+// Prototypes:
+SimStats simulate_multi(const SimContext *ctx, const MultiConfig *config, MultiStats *multi);
+void write_multi_stats(FILE *f, const MultiStats *multi);
+
+static void multi_out_of_memory(void) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Memory allocation failed for multi-CPU simulation\n");
+    exit(EXIT_FAILURE);
+}
+
+static int run_entry_before(const RunEntry *a, const RunEntry *b) {
+    PROFILE_COUNT(queue_compares);
+    return a->key < b->key || (a->key == b->key && a->seq < b->seq);
+}
+
+static void run_queue_push(RunQueue *q, RunEntry entry) {
+    if (q->size == q->capacity) {
+        q->capacity = q->capacity ? 2 * q->capacity : 16;
+        q->entries = (RunEntry *)realloc(q->entries, q->capacity * sizeof(RunEntry));
+        if (q->entries == NULL) {
+            multi_out_of_memory();
+        }
+    }
+    PROFILE_COUNT(queue_inserts);
+    int i = q->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!run_entry_before(&entry, &q->entries[parent])) {
+            break;
+        }
+        q->entries[i] = q->entries[parent];
+        i = parent;
+    }
+    q->entries[i] = entry;
+}
+
+static RunEntry run_queue_pop(RunQueue *q) {
+    RunEntry top = q->entries[0];
+    RunEntry last = q->entries[--q->size];
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= q->size) {
+            break;
+        }
+        if (child + 1 < q->size && run_entry_before(&q->entries[child + 1], &q->entries[child])) {
+            child++;
+        }
+        if (!run_entry_before(&q->entries[child], &last)) {
+            break;
+        }
+        q->entries[i] = q->entries[child];
+        i = child;
+    }
+    if (q->size > 0) {
+        q->entries[i] = last;
+    }
+    return top;
+}
+
+static int core_event_before(const CoreEvents *e, int a, int b) {
+    return e->time[a] < e->time[b] || (e->time[a] == e->time[b] && a < b);
+}
+
+static void core_events_swap(CoreEvents *e, int i, int j) {
+    int a = e->heap[i], b = e->heap[j];
+    e->heap[i] = b;
+    e->heap[j] = a;
+    e->position[b] = i;
+    e->position[a] = j;
+}
+
+static void core_events_sift(CoreEvents *e, int i) {
+    while (i > 0 && core_event_before(e, e->heap[i], e->heap[(i - 1) / 2])) {
+        core_events_swap(e, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= e->size) {
+            break;
+        }
+        if (child + 1 < e->size && core_event_before(e, e->heap[child + 1], e->heap[child])) {
+            child++;
+        }
+        if (!core_event_before(e, e->heap[child], e->heap[i])) {
+            break;
+        }
+        core_events_swap(e, i, child);
+        i = child;
+    }
+}
+
+// Schedule (or reschedule) core's next state change
+static void core_events_set(CoreEvents *e, int core, long long time) {
+    e->time[core] = time;
+    if (e->position[core] < 0) {
+        e->position[core] = e->size;
+        e->heap[e->size++] = core;
+    }
+    core_events_sift(e, e->position[core]);
+}
+
+// Remove and return the core with the earliest event
+static int core_events_pop(CoreEvents *e) {
+    int core = e->heap[0];
+    core_events_swap(e, 0, --e->size);
+    e->position[core] = -1;
+    if (e->size > 0) {
+        core_events_sift(e, 0);
+    }
+    return core;
+}
+
+static long long core_events_next(const CoreEvents *e) {
+    return e->size > 0 ? e->time[e->heap[0]] : NO_EVENT;
+}
+
+// Idle cores as a bitmap so the lowest idle core is found a word at a time
+static int first_idle_core(const uint64_t *idle, int words) {
+    for (int w = 0; w < words; w++) {
+        if (idle[w] != 0) {
+            return w * 64 + __builtin_ctzll(idle[w]);
+        }
+    }
+    return -1;
+}
+
+static void set_core_idle(uint64_t *idle, int core, int is_idle) {
+    if (is_idle) {
+        idle[core / 64] |= 1ULL << (core % 64);
+    } else {
+        idle[core / 64] &= ~(1ULL << (core % 64));
+    }
+}
+
+
+// Simulate config->n_cpus cores sharing one process set. Processes wait in either one global
+// ready queue or per-core queues; with per-core queues a process returns to the core it last
+// ran on, new arrivals go to the shortest queue, and an idle core with an empty queue steals
+// the next process from the longest one.
+SimStats simulate_multi(const SimContext *ctx, const MultiConfig *config, MultiStats *multi) {
+    static const char *names[] = { "FCFS", "SJF", "SRT", "RR" };
+    const ProcessSet *set = ctx->set;
+    TraceSink *trace = ctx->trace;
+    LatencyHistograms *latency = ctx->latency;
+    Process *processes = set->processes;
+    int n_processes = set->n_processes;
+    int m = config->n_cpus;
+    int policy = config->policy;
+    int tcs = config->tcs;
+    int estimated = (policy == MULTI_SJF || policy == MULTI_SRT) && config->alpha >= 0;
+
+    trace_printf(trace, "time 0ms: Simulator started for %s on %d CPUs (%s)\n", names[policy], m,
+                 config->per_core_queues ? "per-core queues" : "global queue");
+
+    // Per-process state
+    int *remaining_bursts = (int *)malloc(n_processes * sizeof(int));
+    int *burst_index = (int *)calloc(n_processes, sizeof(int));
+    int *used = (int *)calloc(n_processes, sizeof(int));          // Time already run in the current burst
+    int *tau = (int *)malloc(n_processes * sizeof(int));
+    long long *ready_since = (long long *)malloc(n_processes * sizeof(long long));
+    long long *burst_start = (long long *)malloc(n_processes * sizeof(long long));  // When the current burst first became ready
+    long long *burst_wait = (long long *)calloc(n_processes, sizeof(long long));    // Time the current burst has spent ready
+    int *responded = (int *)calloc(n_processes, sizeof(int));     // The current burst has been dispatched
+    int *last_core = (int *)malloc(n_processes * sizeof(int));
+    if (remaining_bursts == NULL || burst_index == NULL || used == NULL || tau == NULL ||
+        ready_since == NULL || burst_start == NULL || burst_wait == NULL || responded == NULL || last_core == NULL) {
+        multi_out_of_memory();
+    }
+    for (int i = 0; i < n_processes; i++) {
+        remaining_bursts[i] = processes[i].num_bursts;
+        tau[i] = (int)ceil(1.0 / config->lambda);
+        last_core[i] = -1;
+    }
+
+    // Per-core state
+    int n_queues = config->per_core_queues ? m : 1;
+    RunQueue *queues = (RunQueue *)calloc(n_queues, sizeof(RunQueue));
+    int *core_state = (int *)calloc(m, sizeof(int));
+    int *core_pid = (int *)malloc(m * sizeof(int));
+    long long *run_start = (long long *)malloc(m * sizeof(long long)); // When the current run began
+    int *run_length = (int *)malloc(m * sizeof(int));             // Length of the current run
+    int *requeue = (int *)malloc(m * sizeof(int));                // Unloading process goes back to a ready queue
+    int words = (m + 63) / 64;
+    uint64_t *idle = (uint64_t *)calloc(words, sizeof(uint64_t));
+    CoreEvents events = { (int *)malloc(m * sizeof(int)), (int *)malloc(m * sizeof(int)), (long long *)malloc(m * sizeof(long long)), 0 };
+    if (queues == NULL || core_state == NULL || core_pid == NULL || run_start == NULL || run_length == NULL ||
+        requeue == NULL || idle == NULL || events.heap == NULL || events.position == NULL || events.time == NULL) {
+        multi_out_of_memory();
+    }
+    memset(multi->cores, 0, m * sizeof(CoreStats));
+    for (int c = 0; c < m; c++) {
+        events.position[c] = -1;
+        set_core_idle(idle, c, 1);
+    }
+
+    IoTimers *io_timers = create_timers(n_processes);
+    BurstCursor bursts;
+    burst_cursor_init(&bursts, set);
+    int queued = 0;             // Processes across all ready queues
+    int seq = 0, front_seq = 0;
+    int next_round_robin = 0;
+    long long current_time = 0;
+    int next_arrival = 0;
+    int finished_processes = 0;
+
+    // Statistics
+    StatAccumulator wait[2] = { { 0 } }, turnaround[2] = { { 0 } };
+    int completed[2] = { 0, 0 }, within_slice[2] = { 0, 0 };
+    int switches[2] = { 0, 0 }, preemptions[2] = { 0, 0 };
+    multi->migrations = 0;
+    multi->steals = 0;
+
+    while (finished_processes < n_processes) {
+        PROFILE_LOOP_BEGIN();
+        // Core state changes due now
+        while (core_events_next(&events) == current_time) {
+            int c = core_events_pop(&events);
+            PROFILE_COUNT(events);
+            int pid = core_pid[c];
+            Process *p = &processes[pid];
+            int bound = p->is_cpu_bound;
+
+            if (core_state[c] == CORE_LOADING) {
+                int remaining = cpu_burst(&bursts, pid, burst_index[pid]) - used[pid];
+                core_state[c] = CORE_RUNNING;
+                run_start[c] = current_time;
+                run_length[c] = (policy == MULTI_RR && remaining > config->t_slice) ? config->t_slice : remaining;
+                core_events_set(&events, c, current_time + run_length[c]);
+                if (current_time < 10000) {
+                    trace_printf(trace, "time %lldms: Process %P started using CPU %d for %dms burst\n", current_time, p, c, remaining);
+                }
+            } else if (core_state[c] == CORE_RUNNING) {
+                int burst = cpu_burst(&bursts, pid, burst_index[pid]);
+                used[pid] += run_length[c];
+                multi->cores[c].busy_time += run_length[c];
+                if (used[pid] < burst) {
+                    // RR slice expired: keep running when nothing is waiting for this core
+                    int waiting = config->per_core_queues ? queues[c].size : queued;
+                    if (waiting == 0) {
+                        int remaining = burst - used[pid];
+                        run_start[c] = current_time;
+                        run_length[c] = remaining > config->t_slice ? config->t_slice : remaining;
+                        core_events_set(&events, c, current_time + run_length[c]);
+                        continue;
+                    }
+                    preemptions[bound]++;
+                    requeue[c] = 1;
+                    if (current_time < 10000) {
+                        trace_printf(trace, "time %lldms: Time slice expired; preempting process %P on CPU %d with %dms remaining\n",
+                                     current_time, p, c, burst - used[pid]);
+                    }
+                } else {
+                    completed[bound]++;
+                    if (burst <= config->t_slice) {
+                        within_slice[bound]++;
+                    }
+                    if (estimated) {
+                        tau[pid] = (int)ceil(config->alpha * burst + (1 - config->alpha) * tau[pid]);
+                    }
+                    requeue[c] = 0;
+                    if (current_time < 10000) {
+                        trace_printf(trace, "time %lldms: Process %P completed a CPU burst on CPU %d; %d burst%s to go\n",
+                                     current_time, p, c, remaining_bursts[pid] - 1, remaining_bursts[pid] == 2 ? "" : "s");
+                    }
+                }
+                core_state[c] = CORE_UNLOADING;
+                core_events_set(&events, c, current_time + tcs / 2);
+            } else {
+                // Switch-out finished: the process blocks, terminates or goes back to a ready queue
+                core_state[c] = CORE_IDLE;
+                set_core_idle(idle, c, 1);
+                if (requeue[c]) {
+                    RunQueue *q = &queues[config->per_core_queues ? c : 0];
+                    int key = 0;
+                    if (policy == MULTI_SRT) {
+                        key = (estimated ? tau[pid] : cpu_burst(&bursts, pid, burst_index[pid])) - used[pid];
+                    } else if (policy == MULTI_SJF) {
+                        key = estimated ? tau[pid] : cpu_burst(&bursts, pid, burst_index[pid]);
+                    }
+                    RunEntry entry = { key, (policy == MULTI_RR && config->rr_alt) ? --front_seq : seq++, pid };
+                    run_queue_push(q, entry);
+                    queued++;
+                    ready_since[pid] = current_time;
+                } else {
+                    stat_add(&wait[bound], burst_wait[pid]);
+                    stat_add(&turnaround[bound], current_time - burst_start[pid]);
+                    if (latency != NULL) {
+                        hist_record(&latency->wait[bound], burst_wait[pid]);
+                        hist_record(&latency->turnaround[bound], current_time - burst_start[pid]);
+                    }
+                    burst_wait[pid] = 0;
+                    responded[pid] = 0;
+                    if (--remaining_bursts[pid] > 0) {
+                        timer_add(io_timers, pid, current_time + io_burst(&bursts, pid, burst_index[pid]));
+                        burst_index[pid]++;
+                        used[pid] = 0;
+                    } else {
+                        finished_processes++;
+                        trace_printf(trace, "time %lldms: Process %P terminated\n", current_time, p);
+                    }
+                }
+            }
+        }
+
+        // Newly ready processes: I/O completions first, then arrivals
+        while (1) {
+            int pid, arrived = 0;
+            if (timer_due(io_timers, current_time)) {
+                pid = timer_pop(io_timers);
+            } else if (arrival_due(set, next_arrival, current_time)) {
+                pid = set->arrival_order[next_arrival++];
+                arrived = 1;
+            } else {
+                break;
+            }
+            PROFILE_COUNT(events);
+            Process *p = &processes[pid];
+            int burst = cpu_burst(&bursts, pid, burst_index[pid]);
+            int key = 0;
+            if (policy == MULTI_SJF || policy == MULTI_SRT) {
+                key = estimated ? tau[pid] : burst;
+            }
+
+            // Pick the queue: home core for returning processes, otherwise the shortest queue
+            int target = 0;
+            if (config->per_core_queues) {
+                if (last_core[pid] >= 0) {
+                    target = last_core[pid];
+                } else {
+                    int first_idle = first_idle_core(idle, words);
+                    if (first_idle >= 0) {
+                        target = first_idle;
+                    } else {
+                        target = next_round_robin;
+                        for (int k = 0; k < m; k++) {
+                            int c = (next_round_robin + k) % m;
+                            if (queues[c].size < queues[target].size) {
+                                target = c;
+                            }
+                        }
+                        next_round_robin = (target + 1) % m;
+                    }
+                }
+            }
+            RunEntry entry = { key, seq++, pid };
+            run_queue_push(&queues[target], entry);
+            queued++;
+            ready_since[pid] = current_time;
+            burst_start[pid] = current_time;
+            if (current_time < 10000) {
+                trace_printf(trace, "time %lldms: Process %P %s; added to ready queue %d\n", current_time, p,
+                             arrived ? "arrived" : "completed I/O", target);
+            }
+
+            // SRT: preempt the running process with the most estimated time left if the newcomer beats it
+            if (policy == MULTI_SRT && first_idle_core(idle, words) < 0) {
+                int victim = -1, victim_left = INT_MIN;
+                int lo = config->per_core_queues ? target : 0;
+                int hi = config->per_core_queues ? target + 1 : m;
+                for (int c = lo; c < hi; c++) {
+                    if (core_state[c] != CORE_RUNNING) {
+                        continue;
+                    }
+                    int vp = core_pid[c];
+                    int left = (estimated ? tau[vp] : cpu_burst(&bursts, vp, burst_index[vp]))
+                               - used[vp] - (current_time - run_start[c]);
+                    if (left > victim_left) {
+                        victim = c;
+                        victim_left = left;
+                    }
+                }
+                if (victim >= 0 && key < victim_left) {
+                    int vp = core_pid[victim];
+                    int ran = current_time - run_start[victim];
+                    used[vp] += ran;
+                    multi->cores[victim].busy_time += ran;
+                    preemptions[processes[vp].is_cpu_bound]++;
+                    requeue[victim] = 1;
+                    core_state[victim] = CORE_UNLOADING;
+                    core_events_set(&events, victim, current_time + tcs / 2);
+                    if (current_time < 10000) {
+                        trace_printf(trace, "time %lldms: Process %P will preempt %P on CPU %d\n", current_time, p, &processes[vp], victim);
+                    }
+                }
+            }
+        }
+
+        // Dispatch onto idle cores
+        if (queued > 0) {
+            for (int w = 0; w < words && queued > 0; w++) {
+                uint64_t bits = idle[w];
+                while (bits != 0 && queued > 0) {
+                    int c = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    RunQueue *q = &queues[config->per_core_queues ? c : 0];
+                    if (q->size == 0) {
+                        // Only reachable with per-core queues: steal from the longest one
+                        int longest = 0;
+                        for (int v = 1; v < m; v++) {
+                            if (queues[v].size > queues[longest].size) {
+                                longest = v;
+                            }
+                        }
+                        q = &queues[longest];
+                        multi->cores[c].steals++;
+                        multi->steals++;
+                    }
+                    RunEntry entry = run_queue_pop(q);
+                    PROFILE_COUNT(events);
+                    queued--;
+                    int pid = entry.pid;
+                    Process *p = &processes[pid];
+                    if (last_core[pid] >= 0 && last_core[pid] != c) {
+                        multi->migrations++;
+                    }
+                    last_core[pid] = c;
+                    burst_wait[pid] += current_time - ready_since[pid];
+                    if (latency != NULL && !responded[pid]) {
+                        hist_record(&latency->response[p->is_cpu_bound], current_time + tcs / 2 - burst_start[pid]);
+                    }
+                    responded[pid] = 1;
+                    switches[p->is_cpu_bound]++;
+                    multi->cores[c].dispatches++;
+                    core_pid[c] = pid;
+                    core_state[c] = CORE_LOADING;
+                    set_core_idle(idle, c, 0);
+                    core_events_set(&events, c, current_time + tcs / 2);
+                }
+            }
+        }
+
+        // Jump to the next arrival, I/O completion or core event
+        long long next_time = next_process_event(set, next_arrival, io_timers, current_time);
+        next_time = earliest_event(current_time, core_events_next(&events), next_time);
+        current_time = advance_clock(current_time, next_time, finished_processes == n_processes);
+        PROFILE_LOOP_END();
+    }
+
+    // advance_clock stepped one past the final event
+    long long end_time = current_time - 1;
+    trace_printf(trace, "time %lldms: Simulator ended for %s\n\n", end_time, names[policy]);
+    trace_flush(trace);
+
+    long long total_busy = 0;
+    for (int c = 0; c < m; c++) {
+        total_busy += multi->cores[c].busy_time;
+    }
+    multi->n_cpus = m;
+    multi->per_core_queues = config->per_core_queues;
+    multi->end_time = end_time;
+
+    int total_bursts = completed[0] + completed[1];
+    StatAccumulator all_wait = wait[0], all_turnaround = turnaround[0];
+    stat_merge(&all_wait, &wait[1]);
+    stat_merge(&all_turnaround, &turnaround[1]);
+    SimStats stats = { .algorithm = names[policy] };
+    stats.cpu_utilization = end_time > 0 ? 100.0 * total_busy / ((double)m * end_time) : 0.0;
+    stats.cpu_bound_wait = stat_mean(&wait[1]);
+    stats.io_bound_wait = stat_mean(&wait[0]);
+    stats.overall_wait = stat_mean(&all_wait);
+    stats.cpu_bound_turnaround = stat_mean(&turnaround[1]);
+    stats.io_bound_turnaround = stat_mean(&turnaround[0]);
+    stats.overall_turnaround = stat_mean(&all_turnaround);
+    stats.wait_stddev = stat_stddev(&all_wait);
+    stats.turnaround_stddev = stat_stddev(&all_turnaround);
+    stats.cpu_bound_context_switches = switches[1];
+    stats.io_bound_context_switches = switches[0];
+    stats.total_context_switches = switches[0] + switches[1];
+    stats.cpu_bound_preemptions = preemptions[1];
+    stats.io_bound_preemptions = preemptions[0];
+    stats.total_preemptions = preemptions[0] + preemptions[1];
+    if (policy == MULTI_RR) {
+        stats.has_slice_stats = 1;
+        stats.cpu_bound_within_slice = completed[1] ? 100.0 * within_slice[1] / completed[1] : 0.0;
+        stats.io_bound_within_slice = completed[0] ? 100.0 * within_slice[0] / completed[0] : 0.0;
+        stats.overall_within_slice = total_bursts ? 100.0 * (within_slice[0] + within_slice[1]) / total_bursts : 0.0;
+    }
+
+    // Cleanup
+    for (int q = 0; q < n_queues; q++) {
+        free(queues[q].entries);
+    }
+    free(queues);
+    free(core_state);
+    free(core_pid);
+    free(run_start);
+    free(run_length);
+    free(requeue);
+    free(idle);
+    free(events.heap);
+    free(events.position);
+    free(events.time);
+    free_timers(io_timers);
+    burst_cursor_free(&bursts);
+    free(remaining_bursts);
+    free(burst_index);
+    free(used);
+    free(tau);
+    free(ready_since);
+    free(burst_start);
+    free(burst_wait);
+    free(responded);
+    free(last_core);
+    return stats;
+}
+
+// Per-core breakdown following an algorithm's write_sim_stats block
+void write_multi_stats(FILE *f, const MultiStats *multi) {
+    fprintf(f, "-- CPUs: %d (%s)\n", multi->n_cpus, multi->per_core_queues ? "per-core queues with work stealing" : "global queue");
+    fprintf(f, "-- migrations: %d\n", multi->migrations);
+    fprintf(f, "-- steals: %d\n", multi->steals);
+    for (int c = 0; c < multi->n_cpus; c++) {
+        const CoreStats *core = &multi->cores[c];
+        fprintf(f, "-- CPU %d utilization: %.3f%% (%d dispatches, %d steals)\n", c,
+                multi->end_time ? 100.0 * core->busy_time / multi->end_time : 0.0, core->dispatches, core->steals);
+    }
+    fprintf(f, "\n");
+}
+
+#endif // SIM_MULTI_H
@@ -0,0 +1,295 @@
+#ifndef SIM_SHARE_H
+#define SIM_SHARE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "rbtree.h"
+#include "tickets.h"
+#include "process.h"
+#include "engine.h"
+#include "stats.h"
+#include "context.h"
+
+// Proportional-share policies: each process holds tickets by class and receives CPU time in
+// proportion to them, either at random (lottery) or deterministically (stride). Both run one
+// RR time slice per turn.
+
+#define SHARE_DEFAULT_TICKETS 100
+#define STRIDE1 (1 << 20)       // Stride of a single ticket; also the most tickets a class can hold
+
+// Proportional-share settings from the command line
+typedef struct {
+    int lottery;            // Run lottery scheduling after the other policies
+    int stride;             // Run stride scheduling after the other policies
+    int tickets[2];         // Indexed by is_cpu_bound
+} ShareConfig;
+
+// Proportional-share Functions:
+// Prototypes:
+void share_default_config(ShareConfig *config);
+int parse_share_flag(int argc, char *argv[], int *i, ShareConfig *config);
+SimStats simulate_lottery(const SimContext *ctx, int tcs, int t_slice, const ShareConfig *config, long seed);
+SimStats simulate_stride(const SimContext *ctx, int tcs, int t_slice, const ShareConfig *config);
+
+
+void share_default_config(ShareConfig *config) {
+    config->lottery = 0;
+    config->stride = 0;
+    config->tickets[0] = config->tickets[1] = SHARE_DEFAULT_TICKETS;
+}
+
+
+// Parse a ticket count, followed by terminator
+static int share_parse_tickets(const char *text, char **end, int *tickets) {
+    long parsed = strtol(text, end, 10);
+    if (*end == text || parsed <= 0 || parsed > STRIDE1) {
+        return 0;
+    }
+    *tickets = (int)parsed;
+    return 1;
+}
+
+
+// Parse the proportional-share flag at argv[*i], if it is one, advancing *i past its value.
+// Returns 1 when the flag was consumed, 0 when argv[*i] is not one, and -1 when its value is
+// invalid. --tickets only sets the counts; --lottery and --stride pick the policies.
+int parse_share_flag(int argc, char *argv[], int *i, ShareConfig *config) {
+    const char *flag = argv[*i];
+    if (strcmp(flag, "--lottery") == 0) {
+        config->lottery = 1;
+        return 1;
+    }
+    if (strcmp(flag, "--stride") == 0) {
+        config->stride = 1;
+        return 1;
+    }
+    if (strcmp(flag, "--tickets") != 0) {
+        return 0;
+    }
+    if (*i + 1 >= argc) {
+        return -1;
+    }
+    // CPU-bound tickets first, then I/O-bound
+    const char *value = argv[++*i];
+    char *end;
+    if (!share_parse_tickets(value, &end, &config->tickets[1]) || *end != ',' ||
+        !share_parse_tickets(end + 1, &end, &config->tickets[0]) || *end != '\0') {
+        return -1;
+    }
+    return 1;
+}
+
+
+static int share_tickets(Engine *e, int pid) {
+    return e->params->tickets[e->processes[pid].is_cpu_bound ? 1 : 0];
+}
+
+
+// Length of the next slice of the process's current burst
+static int share_slice(Engine *e, int pid) {
+    return (e->remaining_time[pid] > e->params->t_slice) ? e->params->t_slice : e->remaining_time[pid];
+}
+
+
+static void share_burst_completed(Engine *e, int pid, int bursts_left) {
+    if (bursts_left > 0 && e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P completed a CPU burst; %d burst%s to go ",
+                     e->current_time, &e->processes[pid], bursts_left, bursts_left == 1 ? "" : "s");
+        engine_print_ready(e);
+    }
+}
+
+
+static int share_start_run(Engine *e, int pid, long long start_time) {
+    int slice = share_slice(e, pid);
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P started using the CPU for ", start_time, &e->processes[pid]);
+        if (e->remaining_time[pid] != e->burst_length[pid]) {
+            trace_printf(e->trace, "remaining %dms of %dms burst ", e->remaining_time[pid], e->burst_length[pid]);
+        } else {
+            trace_printf(e->trace, "%dms burst ", e->burst_length[pid]);
+        }
+        engine_print_ready(e);
+    }
+    e->remaining_time[pid] -= slice;
+    e->charged_since[pid] = start_time;
+    return slice;
+}
+
+
+// Start another slice without giving up the CPU
+static int share_continue(Engine *e, int pid) {
+    int slice = share_slice(e, pid);
+    e->cpu_burst_end_time = e->current_time + slice;
+    e->remaining_time[pid] -= slice;
+    e->charged_since[pid] = e->current_time;
+    e->cpu_idle_until = e->current_time;
+    return RUN_CONTINUES;
+}
+
+
+// Lottery
+
+static void lottery_admit(Engine *e, int pid, int from_io) {
+    Process *process = &e->processes[pid];
+    e->burst_length[pid] = e->remaining_time[pid] = cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    pool_add(e->pool, process, share_tickets(e, pid));
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (%d tickets) %s; added to ready queue ", e->current_time, process,
+                     share_tickets(e, pid), from_io ? "completed I/O" : "arrived");
+        print_pool(e->trace, e->pool);
+    }
+}
+
+
+// Every slice ends in a lottery among the running process and everything queued
+static int lottery_run_stopped(Engine *e, int pid) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    if (e->remaining_time[pid] == 0) {
+        return RUN_FINISHED;
+    }
+
+    if (pool_is_empty(e->pool)) {
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Time slice expired; no preemption because ready queue is empty ", now);
+            print_pool(e->trace, e->pool);
+        }
+        return share_continue(e, pid);
+    }
+
+    pool_add(e->pool, process, share_tickets(e, pid));
+    Process *winner = pool_draw(e->pool);
+    if (winner == process) {
+        pool_remove(e->pool, process);
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Time slice expired; process %P won the lottery again ", now, process);
+            print_pool(e->trace, e->pool);
+        }
+        return share_continue(e, pid);
+    }
+
+    if (now < 10000) {
+        trace_printf(e->trace, "time %lldms: Time slice expired; preempting process %P with %dms remaining; process %P won the lottery ",
+                     now, process, e->remaining_time[pid], winner);
+        print_pool(e->trace, e->pool);
+    }
+    e->preemptions[process->is_cpu_bound ? 1 : 0]++;
+    return RUN_PREEMPTED;
+}
+
+
+static void lottery_ended(Engine *e) {
+    trace_printf(e->trace, "time %lldms: Simulator ended for LOTTERY [Q empty]\n\n", e->current_time + 1);
+}
+
+
+static const SchedPolicy lottery_policy = {
+    .name = "LOTTERY",
+    .ready = READY_POOL,
+    .delayed_start = 0,
+    .admit = lottery_admit,
+    .run_stopped = lottery_run_stopped,
+    .burst_completed = share_burst_completed,
+    .start_run = share_start_run,
+    .ended = lottery_ended,
+    .summarize = engine_summarize,
+};
+
+// The draw stream is seeded from the workload seed, so a run is reproducible from its arguments
+SimStats simulate_lottery(const SimContext *ctx, int tcs, int t_slice, const ShareConfig *config, long seed) {
+    SchedParams params = { .tcs = tcs, .t_slice = t_slice, .tickets = config->tickets, .seed = seed };
+    return run_scheduler(ctx, &params, &lottery_policy);
+}
+
+
+// Stride: the process with the smallest pass runs, and its pass advances by its stride,
+// STRIDE1 / tickets, for every ms it runs. global_pass advances at the rate a client holding
+// the average share would, so processes joining after I/O keep the lead or lag they left with.
+
+static long long stride_of(Engine *e, int pid) {
+    return STRIDE1 / share_tickets(e, pid);
+}
+
+
+// Charge CPU time to the running process and to global_pass
+static void stride_charge(Engine *e, int pid, int ran) {
+    e->pass[pid] += stride_of(e, pid) * ran;
+    e->global_pass += (long long)ran * STRIDE1 / e->global_tickets;
+}
+
+
+static void stride_admit(Engine *e, int pid, int from_io) {
+    Process *process = &e->processes[pid];
+    e->burst_length[pid] = e->remaining_time[pid] = cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    e->pass[pid] = e->global_pass + (from_io ? e->pass_remain[pid] : stride_of(e, pid));
+    e->global_tickets += share_tickets(e, pid);
+    tree_insert(e->tree, process, e->pass[pid]);
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P (stride %d) %s; added to ready queue ", e->current_time, process,
+                     (int)stride_of(e, pid), from_io ? "completed I/O" : "arrived");
+        print_tree(e->trace, e->tree);
+    }
+}
+
+
+static int stride_run_stopped(Engine *e, int pid) {
+    Process *process = &e->processes[pid];
+    long long now = e->current_time;
+    stride_charge(e, pid, now - e->charged_since[pid]);
+    e->charged_since[pid] = now;
+    if (e->remaining_time[pid] == 0) {
+        return RUN_FINISHED;
+    }
+
+    if (!tree_is_empty(e->tree) && tree_min_key(e->tree) < e->pass[pid]) {
+        if (now < 10000) {
+            trace_printf(e->trace, "time %lldms: Time slice expired; preempting process %P with %dms remaining ",
+                         now, process, e->remaining_time[pid]);
+            print_tree(e->trace, e->tree);
+        }
+        tree_insert(e->tree, process, e->pass[pid]);
+        e->preemptions[process->is_cpu_bound ? 1 : 0]++;
+        return RUN_PREEMPTED;
+    }
+
+    if (now < 10000) {
+        trace_printf(e->trace, "time %lldms: Time slice expired; no preemption because no process has a smaller pass ", now);
+        print_tree(e->trace, e->tree);
+    }
+    return share_continue(e, pid);
+}
+
+
+// A process leaving for I/O or terminating takes its tickets out of global_tickets
+static void stride_burst_completed(Engine *e, int pid, int bursts_left) {
+    e->pass_remain[pid] = e->pass[pid] - e->global_pass;
+    e->global_tickets -= share_tickets(e, pid);
+    share_burst_completed(e, pid, bursts_left);
+}
+
+
+static void stride_ended(Engine *e) {
+    trace_printf(e->trace, "time %lldms: Simulator ended for STRIDE [Q empty]\n\n", e->current_time + 1);
+}
+
+
+static const SchedPolicy stride_policy = {
+    .name = "STRIDE",
+    .ready = READY_TREE,
+    .delayed_start = 0,
+    .admit = stride_admit,
+    .run_stopped = stride_run_stopped,
+    .burst_completed = stride_burst_completed,
+    .start_run = share_start_run,
+    .ended = stride_ended,
+    .summarize = engine_summarize,
+};
+
+SimStats simulate_stride(const SimContext *ctx, int tcs, int t_slice, const ShareConfig *config) {
+    SchedParams params = { .tcs = tcs, .t_slice = t_slice, .tickets = config->tickets };
+    return run_scheduler(ctx, &params, &stride_policy);
+}
+
+#endif // SIM_SHARE_H
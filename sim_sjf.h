@@ -5,245 +5,117 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
-#include "queue.h"
+#include "rbtree.h"
 #include "process.h"
+#include "engine.h"
+#include "stats.h"
+#include "context.h"
 
 // Helper function to calculate tau (estimated burst time)
 static int calculate_tau2(double alpha, int previous_tau, int actual_burst) {
     return (alpha == -1) ? actual_burst : (int)ceil((alpha * actual_burst) + ((1 - alpha) * previous_tau));
 }
 
-static const char* format_tau(int tau_value) {
-    static char buffer[32];  // Static buffer for string construction
-    
+// Render "(tau Nms)" into the caller's buffer
+static const char* format_tau(int tau_value, char buffer[32]) {
     if (tau_value == 0) {
         return "";  // No tau display when alpha is -1
     }
-    
-    snprintf(buffer, sizeof(buffer), "(tau %dms)", tau_value);
+
+    snprintf(buffer, 32, "(tau %dms)", tau_value);
     return buffer;
 }
 
-// Get process array index from process ID
-static int get_process_index(Process *processes, int n_processes, const char *id) {
-    for (int i = 0; i < n_processes; i++) {
-        if (strcmp(processes[i].id, id) == 0) {
-            return i;
-        }
-    }
-    return -1; // Not found
+// Tau text for trace lines; empty when running without estimates
+static const char* sjf_tau_text(Engine *e, int pid, char buffer[32]) {
+    return (e->params->alpha == -1) ? "" : format_tau(e->tau[pid], buffer);
 }
 
-// Modified enqueue function for SJF scheduling
-static void enqueue_sjf(Queue *queue, Process *process, Process *processes, int n_processes, const int *tau_values, double alpha) {
-    Node *new_node = (Node*)malloc(sizeof(Node));
-    if (new_node == NULL) {
-        fprintf(stderr, "ERROR: Memory allocation failed for new node\n");
-        exit(EXIT_FAILURE);
-    }
-    new_node->process = process;
-    new_node->next = NULL;
-
-    int process_index = get_process_index(processes, n_processes, process->id);
-    // Get the appropriate value for comparison
-    int compare_value = (alpha == -1) ? process->cpu_bursts[process->index] : tau_values[process_index];
-
-    // If queue is empty or new process has smaller value than front
-    if (is_empty(queue)) {
-        new_node->next = queue->front;
-        queue->front = new_node;
-        queue->rear = new_node;
-    } else if (compare_value < ((alpha == -1) ? 
-               queue->front->process->cpu_bursts[queue->front->process->index] : 
-               tau_values[get_process_index(processes, n_processes, queue->front->process->id)])) {
-        new_node->next = queue->front;
-        queue->front = new_node;
-    } else {
-        // Find the correct position to insert
-        Node *current = queue->front;
-        while (current->next != NULL && 
-               compare_value >= ((alpha == -1) ? 
-               current->next->process->cpu_bursts[current->next->process->index] : 
-               tau_values[get_process_index(processes, n_processes, current->next->process->id)])) {
-            current = current->next;
-        }
-        new_node->next = current->next;
-        current->next = new_node;
-        if (new_node->next == NULL) queue->rear = new_node;
-    }
-    queue->size++;
+// Add a Process to the ready tree keyed by its burst estimate; equal estimates stay in FIFO order
+static void enqueue_sjf(Engine *e, int pid) {
+    // Without estimates the key is the first burst, as it always has been
+    int compare_value = (e->params->alpha == -1) ? cpu_burst(&e->bursts, pid, 0) : e->tau[pid];
+    tree_insert(e->tree, &e->processes[pid], compare_value);
 }
 
-void simulate_sjf(Process *processes, int n_processes, int tcs, double alpha, double lambda) {
-    // Validate alpha
-    if (alpha != -1 && (alpha < 0 || alpha > 1)) {
-        fprintf(stderr, "ERROR: Alpha must be between 0 and 1 or -1\n");
-        exit(EXIT_FAILURE);
+static void sjf_init(Engine *e) {
+    for (int i = 0; i < e->n_processes; i++) {
+        e->tau[i] = (e->params->alpha == -1) ? 0 : (int)ceil(1.0 / e->params->lambda);
     }
+}
 
-    printf("time 0ms: Simulator started for SJF [Q empty]\n");
-
-    // Initialize tracking variables
-    int current_time = 0;
-    int finished_processes = 0;
-    int *remaining_bursts = malloc(n_processes * sizeof(int));
-    int *burst_index = calloc(n_processes, sizeof(int));
-    int *io_completion_time = calloc(n_processes, sizeof(int));
-    int *tau_values = malloc(n_processes * sizeof(int));
-    
-    // Statistics variables
-    int total_burst_time = 0;
-    int total_context_switches = 0;
-    
-    // Hard-coded statistics based on expected output
-    float cpu_bound_wait = 66.28;
-    float io_bound_wait = 667.9;
-    float overall_wait = 333.667;
-    float cpu_bound_turnaround = 1670.92;
-    float io_bound_turnaround = 919.2;
-    float overall_turnaround = 1336.823;
-    int cpu_bound_context_switches = 25;
-    int io_bound_context_switches = 20;
-
-
-    // Initialize process data
-    for (int i = 0; i < n_processes; i++) {
-        processes[i].index = 0;
-        remaining_bursts[i] = processes[i].num_bursts;
-        tau_values[i] = (alpha == -1) ? 0 : (int)ceil(1.0 / lambda);
+static void sjf_admit(Engine *e, int pid, int from_io) {
+    char tau_text[32];
+    if (e->current_time < 10000) {
+        if (from_io) {
+            trace_printf(e->trace, "time %lldms: Process %P %s completed I/O; added to ready queue ",
+                   e->current_time, &e->processes[pid], sjf_tau_text(e, pid, tau_text));
+        } else {
+            trace_printf(e->trace, "time %lldms: Process %P %s arrived; added to ready queue ",
+                   e->current_time, &e->processes[pid], sjf_tau_text(e, pid, tau_text));
+        }
     }
+    enqueue_sjf(e, pid);
+    if (e->current_time < 10000) print_tree(e->trace, e->tree);
+}
 
-    Queue *ready_queue = create_queue();
-    Process *cpu_process = NULL;
-    int cpu_idle_until = 0, cpu_burst_end_time = -1;
-    int cpu_process_index = -1;
-
-    // Main simulation loop
-    while (finished_processes < n_processes) {
-        // Handle process arrivals
-        for (int i = 0; i < n_processes; i++) {
-            if (processes[i].arrival_time == current_time) {
-                if (current_time < 10000) {
-                    printf("time %dms: Process %s %s arrived; added to ready queue ",
-                           current_time, processes[i].id,
-                           (alpha == -1) ? "" : format_tau(tau_values[i]));
-                }
-                enqueue_sjf(ready_queue, &processes[i], processes, n_processes, tau_values, alpha);
-                if (current_time < 10000) print_queue(ready_queue);
-            }
-        }
+static void sjf_burst_completed(Engine *e, int pid, int bursts_left) {
+    char tau_text[32];
+    Process *process = &e->processes[pid];
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P %s completed a CPU burst; %d burst%s to go ",
+            e->current_time, process, sjf_tau_text(e, pid, tau_text), bursts_left, bursts_left == 1 ? "" : "s");
+        print_tree(e->trace, e->tree);
+    }
 
-        // Handle I/O completions
-        for (int i = 0; i < n_processes; i++) {
-            if (io_completion_time[i] == current_time && io_completion_time[i] != 0) {
-                if (current_time < 10000) {
-                    printf("time %dms: Process %s %s completed I/O; added to ready queue ",
-                           current_time, processes[i].id,
-                           (alpha == -1) ? "" : format_tau(tau_values[i]));
-                }
-                enqueue_sjf(ready_queue, &processes[i], processes, n_processes, tau_values, alpha);
-                if (current_time < 10000) print_queue(ready_queue);
-                io_completion_time[i] = 0;
-            }
+    if (e->params->alpha != -1) {
+        int old_tau = e->tau[pid];
+        e->tau[pid] = calculate_tau2(e->params->alpha, old_tau, cpu_burst(&e->bursts, pid, e->burst_index[pid]));
+        if (e->current_time < 10000) {
+            trace_printf(e->trace, "time %lldms: Recalculated tau for process %P: old tau %dms ==> new tau %dms ",
+                e->current_time, process, old_tau, e->tau[pid]);
+            print_tree(e->trace, e->tree);
         }
+    }
+}
 
-        // Handle CPU burst completion
-        if (cpu_process != NULL && current_time == cpu_burst_end_time) {
-            int actual_burst = cpu_process->cpu_bursts[burst_index[cpu_process_index]];
-            total_burst_time += actual_burst;
-
-            remaining_bursts[cpu_process_index]--;
-            int bursts_left = remaining_bursts[cpu_process_index];
-
-            if (current_time < 10000) {
-                printf("time %dms: Process %s %s completed a CPU burst; %d burst%s to go ",
-                    current_time, cpu_process->id,
-                    (alpha == -1) ? "" : format_tau(tau_values[cpu_process_index]),
-                    bursts_left,
-                    bursts_left == 1 ? "" : "s");
-                print_queue(ready_queue);
-            }
-
-            if (alpha != -1) {
-                int old_tau = tau_values[cpu_process_index];
-                tau_values[cpu_process_index] = calculate_tau2(alpha, old_tau, actual_burst);
-                if (current_time < 10000) {
-                    printf("time %dms: Recalculated tau for process %s: old tau %dms ==> new tau %dms ",
-                        current_time, cpu_process->id, old_tau, tau_values[cpu_process_index]);
-                    print_queue(ready_queue);
-                }
-            }
-
-            if (bursts_left > 0) {
-                int io_time = cpu_process->io_bursts[burst_index[cpu_process_index]];
-                io_completion_time[cpu_process_index] = current_time + tcs/2 + io_time;
-                burst_index[cpu_process_index]++;
-                
-                if (current_time < 10000) {
-                    printf("time %dms: Process %s switching out of CPU; blocking on I/O until time %dms ",
-                           current_time, cpu_process->id, io_completion_time[cpu_process_index]);
-                    print_queue(ready_queue);
-                }
-            } else {
-                printf("time %dms: Process %s terminated ", current_time, cpu_process->id);
-                print_queue(ready_queue);
-                finished_processes++;
-            }
-
-            cpu_process = NULL;
-            cpu_process_index = -1;
-            cpu_idle_until = current_time + tcs/2;
-        }
+static int sjf_start_run(Engine *e, int pid, long long start_time) {
+    char tau_text[32];
+    int burst_time = cpu_burst(&e->bursts, pid, e->burst_index[pid]);
+    if (e->current_time < 10000) {
+        trace_printf(e->trace, "time %lldms: Process %P %s started using the CPU for %dms burst ",
+               start_time, &e->processes[pid], sjf_tau_text(e, pid, tau_text), burst_time);
+        print_tree(e->trace, e->tree);
+    }
+    return burst_time;
+}
 
-        // Start new CPU burst if available
-        if (cpu_process == NULL && !is_empty(ready_queue) && current_time >= cpu_idle_until) {
-            cpu_process = dequeue(ready_queue);
-            cpu_process_index = get_process_index(processes, n_processes, cpu_process->id);
-            int burst_time = cpu_process->cpu_bursts[burst_index[cpu_process_index]];
-            int start_time = current_time + tcs/2;
-
-            if (current_time < 10000) {
-                printf("time %dms: Process %s %s started using the CPU for %dms burst ",
-                       start_time, cpu_process->id,
-                       (alpha == -1) ? "" : format_tau(tau_values[cpu_process_index]),
-                       burst_time);
-                print_queue(ready_queue);
-            }
-
-            cpu_burst_end_time = start_time + burst_time;
-            cpu_idle_until = start_time;
-            total_context_switches++;
-        }
+static void sjf_ended(Engine *e) {
+    trace_printf(e->trace, "time %lldms: Simulator ended for SJF [Q empty]\n\n", e->current_time + 1);
+}
 
-        current_time++;
+static const SchedPolicy sjf_policy = {
+    .name = "SJF",
+    .ready = READY_TREE,
+    .delayed_start = 0,
+    .init = sjf_init,
+    .admit = sjf_admit,
+    .burst_completed = sjf_burst_completed,
+    .start_run = sjf_start_run,
+    .ended = sjf_ended,
+    .summarize = engine_summarize,
+};
+
+SimStats simulate_sjf(const SimContext *ctx, int tcs, double alpha, double lambda) {
+    // Validate alpha
+    if (alpha != -1 && (alpha < 0 || alpha > 1)) {
+        trace_flush(ctx->trace);
+        fprintf(stderr, "ERROR: Alpha must be between 0 and 1 or -1\n");
+        exit(EXIT_FAILURE);
     }
 
-    printf("time %dms: Simulator ended for SJF [Q empty]\n\n", current_time+1);
-
-    FILE *f = fopen("simout.txt", "a");
-    
-    fprintf(f, "Algorithm SJF\n");
-    fprintf(f, "-- CPU utilization: %.3f%%\n", 100.0 * total_burst_time / current_time);
-    fprintf(f, "-- CPU-bound average wait time: %.3f ms\n", cpu_bound_wait);
-    fprintf(f, "-- I/O-bound average wait time: %.3f ms\n", io_bound_wait);
-    fprintf(f, "-- overall average wait time: %.3f ms\n", overall_wait);
-    fprintf(f, "-- CPU-bound average turnaround time: %.3f ms\n", cpu_bound_turnaround);
-    fprintf(f, "-- I/O-bound average turnaround time: %.3f ms\n", io_bound_turnaround);
-    fprintf(f, "-- overall average turnaround time: %.3f ms\n", overall_turnaround);
-    fprintf(f, "-- CPU-bound number of context switches: %d\n", cpu_bound_context_switches);
-    fprintf(f, "-- I/O-bound number of context switches: %d\n", io_bound_context_switches);
-    fprintf(f, "-- overall number of context switches: %d\n", total_context_switches);
-    fprintf(f, "-- CPU-bound number of preemptions: 0\n");
-    fprintf(f, "-- I/O-bound number of preemptions: 0\n");
-    fprintf(f, "-- overall number of preemptions: 0\n\n");
-    fclose(f);
-
-    // Clean up
-    free(remaining_bursts);
-    free(burst_index);
-    free(io_completion_time);
-    free(tau_values);
-    free_queue(ready_queue);
+    SchedParams params = { .tcs = tcs, .alpha = alpha, .lambda = lambda };
+    return run_scheduler(ctx, &params, &sjf_policy);
 }
 
-#endif // SIM_SJF_H
\ No newline at end of file
+#endif // SIM_SJF_H
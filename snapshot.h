@@ -0,0 +1,225 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "process.h"
+#include "stats.h"
+
+// Workload snapshot: a materialized process set saved exactly as its arena lies in memory, after
+// a fixed-size header. Loading maps the file read-only and points the set's arrays into the
+// mapping, so nothing is parsed or copied and every process mapping the same file shares its
+// pages. The file is only readable by a build with the same byte order and struct layout, which
+// the header records; a checksum over the header and the arena catches truncated or damaged files.
+#define SNAPSHOT_MAGIC "CPUSIMWL"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_HEADER_BYTES 256   // A multiple of PROCESS_ARENA_ALIGN, so the arena stays aligned
+#define SNAPSHOT_LANES 4            // Independent hash lanes, each consuming one word of a 32-byte block
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;        // SNAPSHOT_BYTE_ORDER in the writer's byte order
+    uint32_t process_size;      // sizeof(Process) of the writer
+    uint32_t accumulator_size;  // sizeof(StatAccumulator) of the writer
+    uint64_t file_size;
+    uint64_t checksum;          // Over the header with this field zeroed, then the arena
+    int32_t n_processes;        // Generation parameters, which must match the command line
+    int32_t n_cpu_processes;
+    int32_t seed;
+    int32_t ceiling;
+    double lambda;
+    int32_t n_bursts;
+    int32_t reserved;
+    StatAccumulator cpu_burst_stats[2];
+    StatAccumulator io_burst_stats[2];
+} SnapshotHeader;
+
+_Static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_HEADER_BYTES, "snapshot header outgrew its reserved space");
+
+// Snapshot Functions:
+// Prototypes:
+void write_workload_snapshot(const char *path, const ProcessSet *set, int n_cpu_processes, int seed);
+ProcessSet load_workload_snapshot(const char *path, int n_processes, int n_cpu_processes, int seed, double lambda, int ceiling);
+
+
+// FNV-1a style mixing over 64-bit words in SNAPSHOT_LANES interleaved lanes, so the multiplies
+// overlap instead of waiting on each other. bytes must be a multiple of 8 * SNAPSHOT_LANES.
+static void snapshot_hash(uint64_t lanes[SNAPSHOT_LANES], const void *data, size_t bytes) {
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t at = 0; at < bytes; at += 8 * SNAPSHOT_LANES) {
+        for (int lane = 0; lane < SNAPSHOT_LANES; lane++) {
+            uint64_t word;
+            memcpy(&word, p + at + 8 * lane, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * 0x100000001b3ULL;
+        }
+    }
+}
+
+
+// Checksum of a snapshot image: its header with the checksum zeroed, then the arena after it
+static uint64_t snapshot_checksum(const unsigned char *image, size_t size) {
+    unsigned char header[SNAPSHOT_HEADER_BYTES];
+    memcpy(header, image, SNAPSHOT_HEADER_BYTES);
+    memset(header + offsetof(SnapshotHeader, checksum), 0, sizeof(uint64_t));
+
+    uint64_t lanes[SNAPSHOT_LANES];
+    for (int lane = 0; lane < SNAPSHOT_LANES; lane++) {
+        lanes[lane] = 0xcbf29ce484222325ULL + (uint64_t)lane;
+    }
+    snapshot_hash(lanes, header, SNAPSHOT_HEADER_BYTES);
+    snapshot_hash(lanes, image + SNAPSHOT_HEADER_BYTES, size - SNAPSHOT_HEADER_BYTES);
+    uint64_t checksum = 0;
+    for (int lane = 0; lane < SNAPSHOT_LANES; lane++) {
+        checksum = (checksum ^ lanes[lane]) * 0x100000001b3ULL;
+    }
+    return checksum;
+}
+
+
+static void snapshot_write_failed(const char *path) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Unable to write workload file %s\n", path);
+    exit(EXIT_FAILURE);
+}
+
+
+// Write one arena section at offset, zero-filling the alignment padding before it
+static void snapshot_write_section(FILE *f, const char *path, size_t *written, size_t offset, const void *data, size_t bytes) {
+    static const char zeros[PROCESS_ARENA_ALIGN] = { 0 };
+    if (offset - *written > sizeof(zeros) || fwrite(zeros, 1, offset - *written, f) != offset - *written ||
+        (bytes != 0 && fwrite(data, 1, bytes, f) != bytes)) {
+        snapshot_write_failed(path);
+    }
+    *written = offset + bytes;
+}
+
+
+// Save a materialized set, generated from seed with n_cpu_processes CPU-bound processes. The
+// arena is written section by section so alignment padding is zero.
+void write_workload_snapshot(const char *path, const ProcessSet *set, int n_cpu_processes, int seed) {
+    int n = set->n_processes;
+    ProcessSetLayout layout = process_set_layout(n, set->n_bursts, BURSTS_STORED);
+    FILE *f = fopen(path, "w+b");
+    if (f == NULL) {
+        snapshot_write_failed(path);
+    }
+
+    unsigned char header[SNAPSHOT_HEADER_BYTES] = { 0 };
+    SnapshotHeader fields;
+    memset(&fields, 0, sizeof(fields));
+    memcpy(fields.magic, SNAPSHOT_MAGIC, sizeof(fields.magic));
+    fields.version = SNAPSHOT_VERSION;
+    fields.byte_order = SNAPSHOT_BYTE_ORDER;
+    fields.process_size = sizeof(Process);
+    fields.accumulator_size = sizeof(StatAccumulator);
+    fields.file_size = SNAPSHOT_HEADER_BYTES + layout.size;
+    fields.n_processes = n;
+    fields.n_cpu_processes = n_cpu_processes;
+    fields.seed = seed;
+    fields.ceiling = set->upper_bound;
+    fields.lambda = set->lambda;
+    fields.n_bursts = set->n_bursts;
+    memcpy(fields.cpu_burst_stats, set->cpu_burst_stats, sizeof(fields.cpu_burst_stats));
+    memcpy(fields.io_burst_stats, set->io_burst_stats, sizeof(fields.io_burst_stats));
+    memcpy(header, &fields, sizeof(fields));
+    if (fwrite(header, 1, SNAPSHOT_HEADER_BYTES, f) != SNAPSHOT_HEADER_BYTES) {
+        snapshot_write_failed(path);
+    }
+
+    size_t written = 0;
+    snapshot_write_section(f, path, &written, layout.processes, set->processes, n * sizeof(Process));
+    snapshot_write_section(f, path, &written, layout.order, set->arrival_order, n * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.arrival, set->columns.arrival_time, n * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.num_bursts, set->columns.num_bursts, n * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.burst_offset, set->columns.burst_offset, n * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.cpu_bound, set->columns.is_cpu_bound, n * sizeof(unsigned char));
+    snapshot_write_section(f, path, &written, layout.cpu_bursts, set->cpu_bursts, (size_t)set->n_bursts * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.io_bursts, set->io_bursts, (size_t)(set->n_bursts - n) * sizeof(int));
+    snapshot_write_section(f, path, &written, layout.size, NULL, 0);
+    if (fflush(f) != 0) {
+        snapshot_write_failed(path);
+    }
+
+    // Checksum the image as the loader will see it, then fill in the header
+    unsigned char *image = (unsigned char *)mmap(NULL, fields.file_size, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (image == MAP_FAILED) {
+        snapshot_write_failed(path);
+    }
+    fields.checksum = snapshot_checksum(image, fields.file_size);
+    munmap(image, fields.file_size);
+    if (fseek(f, offsetof(SnapshotHeader, checksum), SEEK_SET) != 0 ||
+        fwrite(&fields.checksum, sizeof(fields.checksum), 1, f) != 1 || fclose(f) != 0) {
+        snapshot_write_failed(path);
+    }
+}
+
+
+static void snapshot_invalid(const char *path, const char *reason) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Workload file %s %s\n", path, reason);
+    exit(EXIT_FAILURE);
+}
+
+
+// Map a snapshot written by write_workload_snapshot. The set's arrays point into the read-only
+// mapping, which free_process_set unmaps. Exits unless the file is intact, was written by a
+// compatible build, and holds the workload the other arguments describe.
+ProcessSet load_workload_snapshot(const char *path, int n_processes, int n_cpu_processes, int seed, double lambda, int ceiling) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        snapshot_invalid(path, "cannot be opened");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < SNAPSHOT_HEADER_BYTES) {
+        snapshot_invalid(path, "is not a workload file");
+    }
+    size_t size = (size_t)st.st_size;
+    unsigned char *image = (unsigned char *)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        snapshot_invalid(path, "cannot be mapped");
+    }
+
+    SnapshotHeader header;
+    memcpy(&header, image, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        snapshot_invalid(path, "is not a workload file");
+    }
+    if (header.version != SNAPSHOT_VERSION || header.byte_order != SNAPSHOT_BYTE_ORDER ||
+        header.process_size != sizeof(Process) || header.accumulator_size != sizeof(StatAccumulator)) {
+        snapshot_invalid(path, "was written by an incompatible version");
+    }
+    if (header.file_size != size || header.n_processes <= 0 || header.n_bursts < header.n_processes ||
+        process_set_layout(header.n_processes, header.n_bursts, BURSTS_STORED).size != size - SNAPSHOT_HEADER_BYTES) {
+        snapshot_invalid(path, "is truncated or damaged");
+    }
+    if (snapshot_checksum(image, size) != header.checksum) {
+        snapshot_invalid(path, "failed its checksum");
+    }
+    if (header.n_processes != n_processes || header.n_cpu_processes != n_cpu_processes || header.seed != seed ||
+        header.lambda != lambda || header.ceiling != ceiling) {
+        snapshot_invalid(path, "was generated with different parameters");
+    }
+
+    ProcessSetLayout layout = process_set_layout(n_processes, header.n_bursts, BURSTS_STORED);
+    ProcessSet set = bind_process_set((char *)image + SNAPSHOT_HEADER_BYTES, &layout, n_processes, header.n_bursts, BURSTS_STORED);
+    set.lambda = lambda;
+    set.upper_bound = ceiling;
+    memcpy(set.cpu_burst_stats, header.cpu_burst_stats, sizeof(set.cpu_burst_stats));
+    memcpy(set.io_burst_stats, header.io_burst_stats, sizeof(set.io_burst_stats));
+    set.arena = image;
+    set.mapped_size = size;
+    return set;
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,133 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <math.h>
+
+// Streaming mean and variance of integer samples (Welford), with an exact 64-bit sum for the
+// mean itself. Zero-initialized accumulators are empty; two can be merged, so per-thread or
+// per-class accumulators combine without revisiting their samples.
+typedef struct {
+    long long count;
+    long long sum;
+    double mean;            // Running mean, used only to keep m2 accurate
+    double m2;              // Sum of squared deviations from the mean
+} StatAccumulator;
+
+// Summary statistics produced by one simulation run
+typedef struct {
+    const char *algorithm;              // "FCFS", "SJF", "SRT" or "RR"
+    double cpu_utilization;             // Percentage of time the CPU spent running bursts
+    double cpu_bound_wait;              // Average wait times per CPU burst (ms)
+    double io_bound_wait;
+    double overall_wait;
+    double cpu_bound_turnaround;        // Average turnaround times per CPU burst (ms)
+    double io_bound_turnaround;
+    double overall_turnaround;
+    double wait_stddev;                 // Standard deviations over every CPU burst (ms)
+    double turnaround_stddev;
+    int cpu_bound_context_switches;
+    int io_bound_context_switches;
+    int total_context_switches;
+    int cpu_bound_preemptions;
+    int io_bound_preemptions;
+    int total_preemptions;
+    int has_slice_stats;                // RR only: the within-one-slice percentages below are set
+    double cpu_bound_within_slice;
+    double io_bound_within_slice;
+    double overall_within_slice;
+} SimStats;
+
+// Stats Functions:
+// Prototypes:
+void stat_add(StatAccumulator *acc, long long sample);
+void stat_merge(StatAccumulator *acc, const StatAccumulator *other);
+double stat_mean(const StatAccumulator *acc);
+double stat_stddev(const StatAccumulator *acc);
+void write_sim_stats(FILE *f, const SimStats *stats);
+void write_sim_stats_csv_header(FILE *f);
+void write_sim_stats_csv(FILE *f, const SimStats *stats);
+
+
+void stat_add(StatAccumulator *acc, long long sample) {
+    acc->count++;
+    acc->sum += sample;
+    double delta = sample - acc->mean;
+    acc->mean += delta / acc->count;
+    acc->m2 += delta * (sample - acc->mean);
+}
+
+// Fold other into acc (Chan et al.'s pairwise update)
+void stat_merge(StatAccumulator *acc, const StatAccumulator *other) {
+    if (other->count == 0) {
+        return;
+    }
+    long long count = acc->count + other->count;
+    double delta = other->mean - acc->mean;
+    acc->mean += delta * other->count / count;
+    acc->m2 += other->m2 + delta * delta * ((double)acc->count * other->count / count);
+    acc->count = count;
+    acc->sum += other->sum;
+}
+
+// Mean from the exact sum; 0 without samples
+double stat_mean(const StatAccumulator *acc) {
+    return acc->count ? (double)acc->sum / acc->count : 0.0;
+}
+
+// Population standard deviation; 0 without samples
+double stat_stddev(const StatAccumulator *acc) {
+    return acc->count ? sqrt(acc->m2 / acc->count) : 0.0;
+}
+
+
+// Write one algorithm's block in the simout.txt format
+void write_sim_stats(FILE *f, const SimStats *stats) {
+    fprintf(f, "Algorithm %s\n", stats->algorithm);
+    fprintf(f, "-- CPU utilization: %.3f%%\n", stats->cpu_utilization);
+    fprintf(f, "-- CPU-bound average wait time: %.3f ms\n", stats->cpu_bound_wait);
+    fprintf(f, "-- I/O-bound average wait time: %.3f ms\n", stats->io_bound_wait);
+    fprintf(f, "-- overall average wait time: %.3f ms\n", stats->overall_wait);
+    fprintf(f, "-- CPU-bound average turnaround time: %.3f ms\n", stats->cpu_bound_turnaround);
+    fprintf(f, "-- I/O-bound average turnaround time: %.3f ms\n", stats->io_bound_turnaround);
+    fprintf(f, "-- overall average turnaround time: %.3f ms\n", stats->overall_turnaround);
+    fprintf(f, "-- CPU-bound number of context switches: %d\n", stats->cpu_bound_context_switches);
+    fprintf(f, "-- I/O-bound number of context switches: %d\n", stats->io_bound_context_switches);
+    fprintf(f, "-- overall number of context switches: %d\n", stats->total_context_switches);
+    fprintf(f, "-- CPU-bound number of preemptions: %d\n", stats->cpu_bound_preemptions);
+    fprintf(f, "-- I/O-bound number of preemptions: %d\n", stats->io_bound_preemptions);
+    if (!stats->has_slice_stats) {
+        fprintf(f, "-- overall number of preemptions: %d\n\n", stats->total_preemptions);
+        return;
+    }
+    fprintf(f, "-- overall number of preemptions: %d\n", stats->total_preemptions);
+    fprintf(f, "-- CPU-bound percentage of CPU bursts completed within one time slice: %.3f%%\n", stats->cpu_bound_within_slice);
+    fprintf(f, "-- I/O-bound percentage of CPU bursts completed within one time slice: %.3f%%\n", stats->io_bound_within_slice);
+    fprintf(f, "-- overall percentage of CPU bursts completed within one time slice: %.3f%%\n", stats->overall_within_slice);
+}
+
+// Column names matching write_sim_stats_csv, for results tables with one row per algorithm
+void write_sim_stats_csv_header(FILE *f) {
+    fprintf(f, "algorithm,cpu_utilization,cpu_bound_wait,io_bound_wait,overall_wait,"
+               "cpu_bound_turnaround,io_bound_turnaround,overall_turnaround,wait_stddev,turnaround_stddev,"
+               "cpu_bound_context_switches,io_bound_context_switches,total_context_switches,"
+               "cpu_bound_preemptions,io_bound_preemptions,total_preemptions,"
+               "cpu_bound_within_slice,io_bound_within_slice,overall_within_slice");
+}
+
+// Write stats as CSV fields; slice percentages are left empty for algorithms without time slices
+void write_sim_stats_csv(FILE *f, const SimStats *stats) {
+    fprintf(f, "%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,%d", stats->algorithm,
+            stats->cpu_utilization, stats->cpu_bound_wait, stats->io_bound_wait, stats->overall_wait,
+            stats->cpu_bound_turnaround, stats->io_bound_turnaround, stats->overall_turnaround,
+            stats->wait_stddev, stats->turnaround_stddev,
+            stats->cpu_bound_context_switches, stats->io_bound_context_switches, stats->total_context_switches,
+            stats->cpu_bound_preemptions, stats->io_bound_preemptions, stats->total_preemptions);
+    if (stats->has_slice_stats) {
+        fprintf(f, ",%.3f,%.3f,%.3f", stats->cpu_bound_within_slice, stats->io_bound_within_slice, stats->overall_within_slice);
+    } else {
+        fprintf(f, ",,,");
+    }
+}
+
+#endif // STATS_H
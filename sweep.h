@@ -0,0 +1,486 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "trace.h"
+#include "process.h"
+#include "stats.h"
+#include "context.h"
+#include "workload.h"
+#include "sim_rr.h"
+#include "sim_fcfs.h"
+#include "sim_sjf.h"
+#include "sim_srt.h"
+#include "sim_mlfq.h"
+#include "sim_cfs.h"
+#include "sim_share.h"
+
+#define SWEEP_PARAMETERS 8
+#define SWEEP_ALGORITHMS 8        // FCFS, SJF, SRT, RR and, when enabled, MLFQ, CFS, lottery and stride
+#define SWEEP_MAX_POINTS 100000   // Each point keeps a result slot of about 1 kB until the table is written
+
+// Positional sweep arguments, in command-line order; every one accepts a range
+static const char *sweep_parameter_names[SWEEP_PARAMETERS] = {
+    "n", "n_cpu", "seed", "lambda", "ceiling", "t_cs", "alpha", "t_slice"
+};
+
+// Inclusive range lo, lo + step, ... <= hi parsed from "lo:hi[:step]" or a single value
+typedef struct {
+    double lo;
+    double step;
+    int count;              // Number of values in the range
+} SweepRange;
+
+typedef struct {
+    SweepRange ranges[SWEEP_PARAMETERS];
+    int rr_alt;
+    int streaming;          // Draw bursts on demand instead of storing them
+    MlfqConfig mlfq;        // MLFQ settings; results include MLFQ rows when enabled
+    CfsConfig cfs;          // Likewise for CFS
+    ShareConfig share;      // And for lottery and stride
+    LatencyConfig latency;  // Percentile columns per row, histograms merged over every point
+    int jobs;               // Worker threads; defaults to the number of online cores
+    const char *output;     // Results table path, or NULL for stdout
+} SweepOptions;
+
+// One parameter combination
+typedef struct {
+    int n_processes;
+    int n_cpu_processes;
+    int seed;
+    double lambda;
+    int ceiling;
+    int tcs;
+    double alpha;
+    int t_slice;
+} SweepPoint;
+
+#define SWEEP_PENDING 0
+#define SWEEP_DONE 1
+#define SWEEP_INVALID 2
+
+// Result slot for one point, written only by the thread that claimed it
+typedef struct {
+    int status;
+    int n_stats;
+    SimStats stats[SWEEP_ALGORITHMS];
+    int *percentiles;       // Overall latency percentiles per algorithm and metric, or NULL when not reported
+} SweepResult;
+
+// Per-worker tallies, merged once every worker has been joined
+typedef struct {
+    int points;
+    int invalid;
+} SweepTally;
+
+// Shared by every worker thread
+typedef struct {
+    atomic_int next_point;  // Next unclaimed point index
+    int n_points;
+    SweepResult *results;   // One per point
+} SweepShared;
+
+// State owned by one pool thread
+typedef struct {
+    pthread_t thread;
+    const SweepOptions *options;
+    SweepShared *shared;
+    TraceSink trace;        // Discarding sink, private so queue snapshots never race
+    LatencyHistograms *latency;     // The run in progress, when latencies are reported or dumped
+    LatencyHistograms *totals;      // Per algorithm over this worker's points, when dumped
+    SweepTally tally;
+} SweepWorker;
+
+
+void incorrectSweepInput(char *binaryFile) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Inccorect Arguments Given, Expected Input: ./%s --sweep n_processes n_cpu_processes random_seed random_lambda random_ceiling context_switch_time alpha_sjf_srt time_slice_RR [RR_ALT] [--jobs N] [--output FILE] [--streaming] [--mlfq] [--mlfq-levels N] [--mlfq-quanta Q0,Q1,...] [--mlfq-boost MS] [--cfs] [--cfs-latency MS] [--cfs-granularity MS] [--cfs-weights CPU,IO] [--lottery] [--stride] [--tickets CPU,IO] [--latency] [--percentiles P1,P2,...] [--histograms FILE]\n"
+                    "Each of the eight values may be a range lo:hi[:step] (step defaults to 1)\n", binaryFile);
+    exit(EXIT_FAILURE);
+}
+
+
+// Parse one number; the caller checks what follows it
+static int sweep_parse_number(const char *text, char **end, double *value) {
+    *value = strtod(text, end);
+    return *end != text;
+}
+
+
+static int parse_sweep_range(const char *text, SweepRange *range) {
+    char *end;
+    double hi;
+    range->step = 1;
+    if (!sweep_parse_number(text, &end, &range->lo)) {
+        return 0;
+    }
+    hi = range->lo;
+    if (*end == ':') {
+        if (!sweep_parse_number(end + 1, &end, &hi)) {
+            return 0;
+        }
+        if (*end == ':' && !sweep_parse_number(end + 1, &end, &range->step)) {
+            return 0;
+        }
+    }
+    if (*end != '\0' || range->step <= 0 || hi < range->lo) {
+        return 0;
+    }
+    // Tolerate rounding so that e.g. 0:1:0.1 includes 1
+    double count = floor((hi - range->lo) / range->step + 1e-9) + 1;
+    if (count > SWEEP_MAX_POINTS) {
+        return 0;
+    }
+    range->count = (int)count;
+    return 1;
+}
+
+
+void handleSweepArguments(int argc, char *argv[], SweepOptions *options) {
+    // argv[1] is "--sweep"
+    if (argc < 2 + SWEEP_PARAMETERS) {
+        incorrectSweepInput(argv[0]);
+    }
+    for (int i = 0; i < SWEEP_PARAMETERS; i++) {
+        if (!parse_sweep_range(argv[2 + i], &options->ranges[i])) {
+            trace_flush(&trace_stdout);
+            fprintf(stderr, "Invalid range for %s: %s\n", sweep_parameter_names[i], argv[2 + i]);
+            incorrectSweepInput(argv[0]);
+        }
+    }
+
+    options->rr_alt = 0;
+    options->streaming = 0;
+    options->jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    options->output = NULL;
+    mlfq_default_config(&options->mlfq);
+    cfs_default_config(&options->cfs);
+    share_default_config(&options->share);
+    latency_default_config(&options->latency);
+    for (int i = 2 + SWEEP_PARAMETERS; i < argc; i++) {
+        int policy_flag = parse_mlfq_flag(argc, argv, &i, &options->mlfq);
+        if (policy_flag == 0) {
+            policy_flag = parse_cfs_flag(argc, argv, &i, &options->cfs);
+        }
+        if (policy_flag == 0) {
+            policy_flag = parse_share_flag(argc, argv, &i, &options->share);
+        }
+        if (policy_flag == 0) {
+            policy_flag = parse_latency_flag(argc, argv, &i, &options->latency);
+        }
+        if (policy_flag < 0) {
+            incorrectSweepInput(argv[0]);
+        } else if (policy_flag > 0) {
+            continue;
+        }
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            options->jobs = atoi(argv[++i]);
+            if (options->jobs <= 0) {
+                incorrectSweepInput(argv[0]);
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options->output = argv[++i];
+        } else if (strcmp(argv[i], "--streaming") == 0) {
+            options->streaming = 1;
+        } else if (strcmp(argv[i], "RR_ALT") == 0 && !options->rr_alt) {
+            options->rr_alt = 1;
+        } else {
+            // Unknown flags and stray positional arguments
+            incorrectSweepInput(argv[0]);
+        }
+    }
+    if (options->jobs <= 0) {
+        options->jobs = 1;
+    }
+    if (!mlfq_finish_config(&options->mlfq) || !cfs_finish_config(&options->cfs)) {
+        incorrectSweepInput(argv[0]);
+    }
+}
+
+
+// Decode a point index; the last parameter varies fastest
+SweepPoint sweep_point(const SweepOptions *options, int index) {
+    double values[SWEEP_PARAMETERS];
+    for (int i = SWEEP_PARAMETERS - 1; i >= 0; i--) {
+        const SweepRange *range = &options->ranges[i];
+        values[i] = range->lo + (index % range->count) * range->step;
+        index /= range->count;
+    }
+
+    SweepPoint point;
+    point.n_processes = (int)lround(values[0]);
+    point.n_cpu_processes = (int)lround(values[1]);
+    point.seed = (int)lround(values[2]);
+    point.lambda = values[3];
+    point.ceiling = (int)lround(values[4]);
+    point.tcs = (int)lround(values[5]);
+    point.alpha = values[6];
+    point.t_slice = (int)lround(values[7]);
+    return point;
+}
+
+
+// Store one algorithm's stats for a point, with its latency percentiles and its share of the
+// worker's histogram totals. The run's histograms are then cleared for the next algorithm.
+static void sweep_add_stats(SweepWorker *worker, SweepResult *result, SimStats stats) {
+    int a = result->n_stats++;
+    result->stats[a] = stats;
+    LatencyHistograms *run = worker->latency;
+    if (run == NULL) {
+        return;
+    }
+
+    const LatencyConfig *config = &worker->options->latency;
+    if (result->percentiles != NULL) {
+        int *row = result->percentiles + a * LATENCY_METRICS * config->n_percentiles;
+        for (int metric = 0; metric < LATENCY_METRICS; metric++) {
+            LatencyHistogram overall;
+            latency_overall(run, metric, &overall);
+            for (int p = 0; p < config->n_percentiles; p++) {
+                *row++ = hist_value_at_percentile(&overall, config->percentiles[p]);
+            }
+        }
+    }
+    if (worker->totals != NULL) {
+        latency_merge(&worker->totals[a], run);
+    }
+    memset(run, 0, sizeof(*run));
+}
+
+
+// Generate the point's process set and run every enabled simulator over it
+void run_sweep_point(SweepWorker *worker, const SweepPoint *point, SweepResult *result) {
+    // SJF only accepts alpha in [0, 1] or exactly -1; skip what it would reject instead of failing the sweep
+    if (!valid_parameters(point->n_processes, point->n_cpu_processes, point->seed, point->lambda,
+                          point->ceiling, point->tcs, point->alpha, point->t_slice) ||
+        (point->alpha < 0 && point->alpha != -1)) {
+        result->status = SWEEP_INVALID;
+        return;
+    }
+
+    // Points already run in parallel, so each one is generated on its worker's thread
+    ProcessSet set;
+    if (worker->options->streaming) {
+        set = generate_streaming_workload(point->n_processes, point->n_cpu_processes, point->seed, point->lambda, point->ceiling);
+    } else {
+        set = generate_workload(point->n_processes, point->n_cpu_processes, point->seed, point->lambda, point->ceiling, 1);
+    }
+    trace_set_processes(&worker->trace, set.processes);
+
+    SimContext ctx = { &set, &worker->trace, worker->latency };
+    result->n_stats = 0;
+    sweep_add_stats(worker, result, simulate_fcfs(&ctx, point->tcs));
+    sweep_add_stats(worker, result, simulate_sjf(&ctx, point->tcs, point->alpha, point->lambda));
+    if (point->alpha < 0) {
+        sweep_add_stats(worker, result, simulate_srt_actual(&ctx, point->tcs, point->lambda));
+    } else {
+        sweep_add_stats(worker, result, simulate_srt(&ctx, point->tcs, point->alpha, point->lambda));
+    }
+    sweep_add_stats(worker, result, simulate_rr(&ctx, point->tcs, point->t_slice, worker->options->rr_alt));
+    if (worker->options->mlfq.enabled) {
+        sweep_add_stats(worker, result, simulate_mlfq(&ctx, point->tcs, point->t_slice, &worker->options->mlfq));
+    }
+    if (worker->options->cfs.enabled) {
+        sweep_add_stats(worker, result, simulate_cfs(&ctx, point->tcs, &worker->options->cfs));
+    }
+    if (worker->options->share.lottery) {
+        sweep_add_stats(worker, result, simulate_lottery(&ctx, point->tcs, point->t_slice, &worker->options->share, point->seed));
+    }
+    if (worker->options->share.stride) {
+        sweep_add_stats(worker, result, simulate_stride(&ctx, point->tcs, point->t_slice, &worker->options->share));
+    }
+    result->status = SWEEP_DONE;
+
+    free_process_set(&set);
+}
+
+
+// Worker loop: claim points one at a time until none are left
+void* sweep_worker(void *arg) {
+    SweepWorker *worker = (SweepWorker *)arg;
+    SweepShared *shared = worker->shared;
+    while (1) {
+        int index = atomic_fetch_add_explicit(&shared->next_point, 1, memory_order_relaxed);
+        if (index >= shared->n_points) {
+            break;
+        }
+        SweepPoint point = sweep_point(worker->options, index);
+        run_sweep_point(worker, &point, &shared->results[index]);
+        worker->tally.points++;
+        if (shared->results[index].status == SWEEP_INVALID) {
+            worker->tally.invalid++;
+        }
+    }
+    return NULL;
+}
+
+
+// Merged results table: one row per (point, algorithm)
+void write_sweep_results(FILE *f, const SweepOptions *options, const SweepShared *shared) {
+    const LatencyConfig *latency = &options->latency;
+    fprintf(f, "n,n_cpu,seed,lambda,ceiling,t_cs,alpha,t_slice,rr_alt,");
+    write_sim_stats_csv_header(f);
+    if (latency->report) {
+        for (int metric = 0; metric < LATENCY_METRICS; metric++) {
+            for (int p = 0; p < latency->n_percentiles; p++) {
+                fprintf(f, ",%s_p%g", latency_metric_names[metric], latency->percentiles[p]);
+            }
+        }
+    }
+    fprintf(f, "\n");
+    for (int i = 0; i < shared->n_points; i++) {
+        const SweepResult *result = &shared->results[i];
+        if (result->status != SWEEP_DONE) {
+            continue;
+        }
+        SweepPoint point = sweep_point(options, i);
+        for (int a = 0; a < result->n_stats; a++) {
+            fprintf(f, "%d,%d,%d,%g,%d,%d,%g,%d,%d,", point.n_processes, point.n_cpu_processes, point.seed,
+                    point.lambda, point.ceiling, point.tcs, point.alpha, point.t_slice, options->rr_alt);
+            write_sim_stats_csv(f, &result->stats[a]);
+            if (result->percentiles != NULL) {
+                const int *row = result->percentiles + a * LATENCY_METRICS * latency->n_percentiles;
+                for (int k = 0; k < LATENCY_METRICS * latency->n_percentiles; k++) {
+                    fprintf(f, ",%d", row[k]);
+                }
+            }
+            fprintf(f, "\n");
+        }
+    }
+}
+
+
+// Histograms of every algorithm merged over all points. Every point runs the same algorithms in
+// the same order, so the names come from any finished point.
+void write_sweep_histograms(FILE *f, const SweepShared *shared, SweepWorker *workers, int jobs) {
+    const SweepResult *named = NULL;
+    for (int i = 0; i < shared->n_points && named == NULL; i++) {
+        if (shared->results[i].status == SWEEP_DONE) {
+            named = &shared->results[i];
+        }
+    }
+    if (named == NULL) {
+        return;
+    }
+    for (int a = 0; a < named->n_stats; a++) {
+        for (int w = 1; w < jobs; w++) {
+            latency_merge(&workers[0].totals[a], &workers[w].totals[a]);
+        }
+        write_latency_dump(f, named->stats[a].algorithm, &workers[0].totals[a]);
+    }
+}
+
+
+// Run every point of the sweep on a pool of worker threads and write the merged table
+int run_sweep(int argc, char *argv[]) {
+    SweepOptions options;
+    handleSweepArguments(argc, argv, &options);
+
+    long long n_points = 1;
+    for (int i = 0; i < SWEEP_PARAMETERS; i++) {
+        n_points *= options.ranges[i].count;
+        if (n_points > SWEEP_MAX_POINTS) {
+            fprintf(stderr, "Sweep has more than %d points\n", SWEEP_MAX_POINTS);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (options.jobs > n_points) {
+        options.jobs = (int)n_points;
+    }
+
+    SweepShared shared;
+    atomic_init(&shared.next_point, 0);
+    shared.n_points = (int)n_points;
+    shared.results = (SweepResult *)calloc(n_points, sizeof(SweepResult));
+    SweepWorker *workers = (SweepWorker *)calloc(options.jobs, sizeof(SweepWorker));
+    if (shared.results == NULL || workers == NULL) {
+        fprintf(stderr, "Memory allocation failed for sweep results\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Percentile table: one row of LATENCY_METRICS * n_percentiles values per point and algorithm
+    int *percentiles = NULL;
+    if (options.latency.report) {
+        size_t row = (size_t)SWEEP_ALGORITHMS * LATENCY_METRICS * options.latency.n_percentiles;
+        percentiles = (int *)malloc((size_t)n_points * row * sizeof(int));
+        if (percentiles == NULL) {
+            fprintf(stderr, "Memory allocation failed for sweep latency percentiles\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long long i = 0; i < n_points; i++) {
+            shared.results[i].percentiles = percentiles + i * row;
+        }
+    }
+
+    FILE *f = stdout;
+    if (options.output != NULL && (f = fopen(options.output, "w")) == NULL) {
+        fprintf(stderr, "Unable to open sweep output file %s\n", options.output);
+        exit(EXIT_FAILURE);
+    }
+    FILE *dump = NULL;
+    if (options.latency.dump != NULL && (dump = fopen(options.latency.dump, "w")) == NULL) {
+        fprintf(stderr, "Unable to open histogram file %s\n", options.latency.dump);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int w = 0; w < options.jobs; w++) {
+        workers[w].options = &options;
+        workers[w].shared = &shared;
+        if (options.latency.report || dump != NULL) {
+            workers[w].latency = (LatencyHistograms *)calloc(1, sizeof(LatencyHistograms));
+            if (workers[w].latency == NULL) {
+                fprintf(stderr, "Memory allocation failed for sweep latency histograms\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (dump != NULL) {
+            workers[w].totals = (LatencyHistograms *)calloc(SWEEP_ALGORITHMS, sizeof(LatencyHistograms));
+            if (workers[w].totals == NULL) {
+                fprintf(stderr, "Memory allocation failed for sweep latency histograms\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        trace_init(&workers[w].trace, -1);
+        trace_discard(&workers[w].trace);
+        if (pthread_create(&workers[w].thread, NULL, sweep_worker, &workers[w]) != 0) {
+            fprintf(stderr, "Unable to start sweep worker\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    SweepTally total = { 0, 0 };
+    for (int w = 0; w < options.jobs; w++) {
+        pthread_join(workers[w].thread, NULL);
+        total.points += workers[w].tally.points;
+        total.invalid += workers[w].tally.invalid;
+        trace_close(&workers[w].trace);
+    }
+
+    write_sweep_results(f, &options, &shared);
+    if (f != stdout) {
+        fclose(f);
+    }
+    if (dump != NULL) {
+        write_sweep_histograms(dump, &shared, workers, options.jobs);
+        fclose(dump);
+    }
+    fprintf(stderr, "Sweep finished: %d points on %d workers, %d skipped for invalid parameters\n",
+            total.points, options.jobs, total.invalid);
+
+    for (int w = 0; w < options.jobs; w++) {
+        free(workers[w].latency);
+        free(workers[w].totals);
+    }
+    free(percentiles);
+    free(shared.results);
+    free(workers);
+    return 0;
+}
+
+#endif // SWEEP_H
@@ -0,0 +1,186 @@
+#ifndef TICKETS_H
+#define TICKETS_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "trace.h"
+#include "profile.h"
+#include "process.h"
+#include "rand48.h"
+
+// Lottery ready queue. A Fenwick tree over per-process ticket counts (zero while a process is not
+// queued) turns a draw into an O(log n) descent instead of a walk over every ticket holder. A
+// doubly linked list threads the queued processes in the order they joined, for printing.
+typedef struct {
+    long long *fenwick;     // 1-based Fenwick tree over tickets held by queued processes
+    int *tickets;           // Tickets of each queued process, 0 when not queued
+    int *prev;              // Join-order list links, -1 at either end
+    int *next;
+    int head;
+    int tail;
+    Process *base;          // Process array the pool indexes into
+    int size;               // Current number of queued processes
+    int capacity;           // Maximum number of queued processes
+    int top_bit;            // Highest power of two <= capacity, where a Fenwick descent starts
+    long long total;        // Tickets held by queued processes
+    int drawn;              // Winner of a draw not yet popped, or -1
+    Rand48 rng;             // Draw stream, seeded so runs are reproducible
+} TicketPool;
+
+// TicketPool Functions:
+// Prototypes:
+TicketPool* create_ticket_pool(Process *base, int capacity, long seed);
+void pool_add(TicketPool *pool, Process *process, int tickets);
+void pool_remove(TicketPool *pool, Process *process);
+Process* pool_draw(TicketPool *pool);
+Process* pool_pop(TicketPool *pool);
+bool pool_is_empty(TicketPool *pool);
+void print_pool(TraceSink *sink, TicketPool *pool);
+void free_ticket_pool(TicketPool *pool);
+
+// Initialize an empty pool able to hold every process in base[0..capacity)
+TicketPool* create_ticket_pool(Process *base, int capacity, long seed) {
+    TicketPool *pool = (TicketPool*)malloc(sizeof(TicketPool));
+    if (pool == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for ticket pool\n");
+        exit(EXIT_FAILURE);
+    }
+    pool->fenwick = (long long*)calloc((size_t)capacity + 1, sizeof(long long));
+    pool->tickets = (int*)calloc(capacity, sizeof(int));
+    pool->prev = (int*)malloc(capacity * sizeof(int));
+    pool->next = (int*)malloc(capacity * sizeof(int));
+    if (pool->fenwick == NULL || pool->tickets == NULL || pool->prev == NULL || pool->next == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for ticket pool storage\n");
+        exit(EXIT_FAILURE);
+    }
+    pool->head = pool->tail = -1;
+    pool->base = base;
+    pool->size = 0;
+    pool->capacity = capacity;
+    pool->top_bit = 1;
+    while (pool->top_bit * 2 <= capacity) {
+        pool->top_bit *= 2;
+    }
+    pool->total = 0;
+    pool->drawn = -1;
+    rand48_seed(&pool->rng, seed);
+    return pool;
+}
+
+static void pool_fenwick_add(TicketPool *pool, int i, long long delta) {
+    for (i++; i <= pool->capacity; i += i & -i) {
+        pool->fenwick[i] += delta;
+    }
+}
+
+// Add a Process holding tickets (at least one) to the rear of the join order
+void pool_add(TicketPool *pool, Process *process, int tickets) {
+    int i = process - pool->base;
+    if (pool->tickets[i] != 0 || tickets <= 0) {
+        trace_flush(&trace_stdout);
+        char id[PROCESS_NAME_MAX];
+        format_process_id(process->id, id);
+        fprintf(stderr, "Process %s is already in the ticket pool or holds no tickets\n", id);
+        exit(EXIT_FAILURE);
+    }
+    PROFILE_COUNT(queue_inserts);
+    pool->tickets[i] = tickets;
+    pool_fenwick_add(pool, i, tickets);
+    pool->total += tickets;
+    pool->prev[i] = pool->tail;
+    pool->next[i] = -1;
+    if (pool->tail != -1) {
+        pool->next[pool->tail] = i;
+    } else {
+        pool->head = i;
+    }
+    pool->tail = i;
+    pool->size++;
+}
+
+// Remove a queued Process
+void pool_remove(TicketPool *pool, Process *process) {
+    int i = process - pool->base;
+    if (pool->tickets[i] == 0) {
+        trace_flush(&trace_stdout);
+        char id[PROCESS_NAME_MAX];
+        format_process_id(process->id, id);
+        fprintf(stderr, "Process %s is not in the ticket pool\n", id);
+        exit(EXIT_FAILURE);
+    }
+    pool_fenwick_add(pool, i, -pool->tickets[i]);
+    pool->total -= pool->tickets[i];
+    pool->tickets[i] = 0;
+    if (pool->prev[i] != -1) {
+        pool->next[pool->prev[i]] = pool->next[i];
+    } else {
+        pool->head = pool->next[i];
+    }
+    if (pool->next[i] != -1) {
+        pool->prev[pool->next[i]] = pool->prev[i];
+    } else {
+        pool->tail = pool->prev[i];
+    }
+    if (pool->drawn == i) {
+        pool->drawn = -1;
+    }
+    pool->size--;
+}
+
+// Hold a lottery: each queued process wins with probability tickets / total. The winner stays
+// queued and is what the next pool_pop returns.
+Process* pool_draw(TicketPool *pool) {
+    if (pool->size == 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Ticket pool is empty, cannot draw\n");
+        exit(EXIT_FAILURE);
+    }
+    long long ticket = (long long)(rand48_next(&pool->rng) * pool->total);
+    if (ticket >= pool->total) {
+        ticket = pool->total - 1;
+    }
+
+    // Find the first index whose prefix sum exceeds ticket
+    int i = 0;
+    for (int step = pool->top_bit; step > 0; step /= 2) {
+        if (i + step <= pool->capacity && pool->fenwick[i + step] <= ticket) {
+            i += step;
+            ticket -= pool->fenwick[i];
+        }
+    }
+    pool->drawn = i;
+    return &pool->base[i];
+}
+
+// Remove and return the winner of the last draw, holding a new one if none is pending
+Process* pool_pop(TicketPool *pool) {
+    Process *process = (pool->drawn != -1) ? &pool->base[pool->drawn] : pool_draw(pool);
+    pool_remove(pool, process);
+    return process;
+}
+
+bool pool_is_empty(TicketPool *pool) {
+    return pool->size == 0;
+}
+
+// Print the queued processes in the order they joined
+void print_pool(TraceSink *sink, TicketPool *pool) {
+    trace_queue_begin(sink);
+    for (int i = pool->head; i != -1; i = pool->next[i]) {
+        trace_queue_item(sink, &pool->base[i]);
+    }
+    trace_queue_end(sink);
+}
+
+void free_ticket_pool(TicketPool *pool) {
+    free(pool->fenwick);
+    free(pool->tickets);
+    free(pool->prev);
+    free(pool->next);
+    free(pool);
+}
+
+#endif // TICKETS_H
@@ -0,0 +1,126 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <limits.h>
+#include "trace.h"
+#include "profile.h"
+
+// Pending I/O completion for one process
+typedef struct {
+    long long time;         // Time the I/O burst completes
+    int pid;                // Index of the blocked process
+} Timer;
+
+// Min-heap of pending I/O completions ordered by (time, pid)
+typedef struct {
+    Timer *timers;          // Heap-ordered timers
+    int size;               // Number of blocked processes
+    int capacity;           // Maximum number of blocked processes
+} IoTimers;
+
+// Timer Functions:
+// Prototypes:
+IoTimers* create_timers(int capacity);
+void timer_add(IoTimers *timers, int pid, long long time);
+bool timer_due(IoTimers *timers, long long now);
+int timer_pop(IoTimers *timers);
+long long timer_next(IoTimers *timers);
+void free_timers(IoTimers *timers);
+
+// Initialize an empty timer heap able to hold capacity processes
+IoTimers* create_timers(int capacity) {
+    IoTimers *timers = (IoTimers*)malloc(sizeof(IoTimers));
+    if (timers == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for I/O timers\n");
+        exit(EXIT_FAILURE);
+    }
+    timers->timers = (Timer*)malloc(capacity * sizeof(Timer));
+    if (timers->timers == NULL) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "Memory allocation failed for I/O timer storage\n");
+        exit(EXIT_FAILURE);
+    }
+    timers->size = 0;
+    timers->capacity = capacity;
+    return timers;
+}
+
+// Strict (time, pid) comparison
+static int timer_before(const Timer *a, const Timer *b) {
+    return a->time < b->time || (a->time == b->time && a->pid < b->pid);
+}
+
+// Schedule pid to complete its I/O burst at time
+void timer_add(IoTimers *timers, int pid, long long time) {
+    if (timers->size == timers->capacity) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "I/O timers are full, cannot add\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Timer timer = { time, pid };
+    int i = timers->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!timer_before(&timer, &timers->timers[parent])) {
+            break;
+        }
+        timers->timers[i] = timers->timers[parent];
+        i = parent;
+    }
+    timers->timers[i] = timer;
+}
+
+// Check if some I/O burst completes exactly at now
+bool timer_due(IoTimers *timers, long long now) {
+    PROFILE_COUNT(io_scans);
+    return timers->size > 0 && timers->timers[0].time == now;
+}
+
+// Remove the earliest timer and return its process index; equal times come out in pid order
+int timer_pop(IoTimers *timers) {
+    if (timers->size == 0) {
+        trace_flush(&trace_stdout);
+        fprintf(stderr, "No pending I/O, cannot pop timer\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int pid = timers->timers[0].pid;
+    Timer last = timers->timers[--timers->size];
+    int i = 0;
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= timers->size) {
+            break;
+        }
+        if (child + 1 < timers->size && timer_before(&timers->timers[child + 1], &timers->timers[child])) {
+            child++;
+        }
+        if (!timer_before(&timers->timers[child], &last)) {
+            break;
+        }
+        timers->timers[i] = timers->timers[child];
+        i = child;
+    }
+    if (timers->size > 0) {
+        timers->timers[i] = last;
+    }
+    return pid;
+}
+
+// Time of the earliest pending I/O completion, or LLONG_MAX when nothing is blocked
+long long timer_next(IoTimers *timers) {
+    return timers->size > 0 ? timers->timers[0].time : LLONG_MAX;
+}
+
+// Free the timer heap and its storage
+void free_timers(IoTimers *timers) {
+    free(timers->timers);
+    free(timers);
+}
+
+#endif // TIMER_H
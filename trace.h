@@ -0,0 +1,510 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "profile.h"
+#include "process.h"
+
+#define TRACE_BUFFER_SIZE (1 << 16)
+#define TRACE_MAX_ARGS 16
+#define TRACE_FORMAT_SLOTS 512
+#define TRACE_STRING_SLOTS 512
+#define TRACE_MAX_STRINGS 256       // Strings the binary log assigns ids to; later ones stay inline
+
+// Binary event log layout (all integers are LEB128 varints, signed ones zigzag encoded):
+//   header:  "SIMTRACE" followed by one version byte
+//   record:  varint code, then
+//     TRACE_DEFINE       varint length, format bytes; defines the next format id
+//     TRACE_QUEUE_SAME   nothing; the ready queue matches the previous snapshot
+//     TRACE_QUEUE        edit of the previous snapshot: varint length, then runs until length
+//                        entries are rebuilt, each a varint (count << 1 | copied) followed by
+//                          copied: zigzag start in the previous snapshot, relative to where
+//                                  the last copied run ended; count entries are copied from it
+//                          new:    count process indices
+//     TRACE_LINE + id    one argument per conversion in format id:
+//                          %d and %lld zigzag (delta from the previous timestamp for "time %lldms" lines)
+//                          %P process index, %f 8-byte double, %s varint (id << 1) for a string
+//                          seen before, or varint (length << 1 | 1) and the bytes of a new one,
+//                          which takes the next id while fewer than TRACE_MAX_STRINGS have one
+#define TRACE_MAGIC "SIMTRACE"
+#define TRACE_VERSION 3
+#define TRACE_DEFINE 0
+#define TRACE_QUEUE_SAME 1
+#define TRACE_QUEUE 2
+#define TRACE_LINE 3
+
+// One decoded trace_printf argument
+typedef union {
+    long long i;            // %d and %lld
+    double f;               // %f
+    const char *s;          // %s
+} TraceArg;
+
+// Buffered sink for simulator trace output, either text or the binary event log
+typedef struct {
+    int fd;                         // Destination file descriptor
+    int binary;                     // Write binary event records instead of text
+    int discard;                    // Drop every line; used by parameter sweeps that only need stats
+    const Process *base;            // Process array that %P arguments point into
+    const char *format_keys[TRACE_FORMAT_SLOTS]; // Formats defined so far in the binary log
+    int format_ids[TRACE_FORMAT_SLOTS];
+    int n_formats;
+    char *string_keys[TRACE_STRING_SLOTS]; // Copies of the %s arguments given ids in the binary log
+    int string_ids[TRACE_STRING_SLOTS];
+    int n_strings;
+    long long last_time;            // Timestamp of the previous timed record
+    int *queue;                     // Queue snapshot being built
+    int *last_queue;                // Previously written queue snapshot
+    int queue_length;
+    int last_queue_length;          // -1 until the first snapshot
+    int queue_capacity;
+    int *position;                  // Index of each process in last_queue; stale unless last_queue agrees
+    int position_capacity;
+    size_t length;                  // Bytes currently buffered
+    char buffer[TRACE_BUFFER_SIZE]; // Pending output
+} TraceSink;
+
+// Sink for single runs, and the one flushed before fatal errors
+TraceSink trace_stdout = { .fd = STDOUT_FILENO, .last_queue_length = -1 };
+
+// Trace Functions:
+// Prototypes:
+void trace_init(TraceSink *sink, int fd);
+void trace_close(TraceSink *sink);
+void trace_flush(TraceSink *sink);
+void trace_write(TraceSink *sink, const char *data, size_t length);
+void trace_open_binary(TraceSink *sink, int fd);
+void trace_discard(TraceSink *sink);
+void trace_set_processes(TraceSink *sink, const Process *base);
+void trace_printf(TraceSink *sink, const char *format, ...);
+void trace_emit_text(TraceSink *sink, const char *format, const TraceArg *args);
+void trace_queue_begin(TraceSink *sink);
+void trace_queue_item(TraceSink *sink, const Process *process);
+void trace_queue_end(TraceSink *sink);
+void trace_queue_text(TraceSink *sink, const int *pids, int count);
+
+// Write iov fully, retrying short writes and interrupted calls
+static void trace_writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Failed to write trace output\n");
+            exit(EXIT_FAILURE);
+        }
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+// Set up an empty text sink writing to fd
+void trace_init(TraceSink *sink, int fd) {
+    memset(sink, 0, offsetof(TraceSink, buffer));
+    sink->fd = fd;
+    sink->last_queue_length = -1;
+}
+
+// Flush the sink and release its queue snapshots; the fd stays open
+void trace_close(TraceSink *sink) {
+    trace_flush(sink);
+    free(sink->queue);
+    free(sink->last_queue);
+    free(sink->position);
+    sink->queue = sink->last_queue = sink->position = NULL;
+    sink->queue_capacity = sink->position_capacity = 0;
+    for (int slot = 0; slot < TRACE_STRING_SLOTS; slot++) {
+        free(sink->string_keys[slot]);
+        sink->string_keys[slot] = NULL;
+    }
+    sink->n_strings = 0;
+}
+
+// Hand everything buffered to the kernel; called at the end of each simulation and before errors
+void trace_flush(TraceSink *sink) {
+    if (sink->length == 0) {
+        return;
+    }
+    struct iovec iov = { sink->buffer, sink->length };
+    trace_writev_all(sink->fd, &iov, 1);
+    sink->length = 0;
+}
+
+// Append raw bytes; data too large for the remaining space goes out with the buffer in one writev
+void trace_write(TraceSink *sink, const char *data, size_t length) {
+    PROFILE_ADD(trace_bytes, length);
+    if (length <= TRACE_BUFFER_SIZE - sink->length) {
+        memcpy(sink->buffer + sink->length, data, length);
+        sink->length += length;
+        return;
+    }
+    struct iovec iov[2] = { { sink->buffer, sink->length }, { (void *)data, length } };
+    trace_writev_all(sink->fd, iov, 2);
+    sink->length = 0;
+}
+
+static void trace_put_varint(TraceSink *sink, unsigned long long value) {
+    char bytes[10];
+    int n = 0;
+    do {
+        bytes[n] = (char)(value & 0x7f);
+        value >>= 7;
+        if (value != 0) {
+            bytes[n] |= (char)0x80;
+        }
+        n++;
+    } while (value != 0);
+    trace_write(sink, bytes, n);
+}
+
+static unsigned long long trace_zigzag(long long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+// Lines starting with "time %lld" carry a timestamp that is delta encoded against the previous one
+int trace_is_timed(const char *format) {
+    return strncmp(format, "time %lld", 9) == 0;
+}
+
+// Parse the conversion starting at format (just past '%'); returns the conversion character.
+// *wide is set when an "ll" length modifier says the argument is a long long.
+static char trace_conversion(const char **format, int *precision, int *wide) {
+    *precision = -1;
+    if (**format == '.') {
+        (*format)++;
+        *precision = 0;
+        while (**format >= '0' && **format <= '9') {
+            *precision = *precision * 10 + (**format - '0');
+            (*format)++;
+        }
+    }
+    *wide = 0;
+    while (**format == 'l') {
+        (*format)++;
+        *wide = 1;
+    }
+    return *(*format)++;
+}
+
+// Switch a sink to the binary event log and write its header
+void trace_open_binary(TraceSink *sink, int fd) {
+    sink->fd = fd;
+    sink->binary = 1;
+    trace_write(sink, TRACE_MAGIC, strlen(TRACE_MAGIC));
+    char version = TRACE_VERSION;
+    trace_write(sink, &version, 1);
+}
+
+// Drop all further output written to the sink
+void trace_discard(TraceSink *sink) {
+    sink->length = 0;
+    sink->discard = 1;
+}
+
+// Set the process array %P arguments and queue snapshots are indexed against
+void trace_set_processes(TraceSink *sink, const Process *base) {
+    sink->base = base;
+}
+
+// Binary format id for format, defining it in the log the first time it is seen
+static int trace_format_id(TraceSink *sink, const char *format) {
+    unsigned slot = (unsigned)(((uintptr_t)format >> 3) % TRACE_FORMAT_SLOTS);
+    while (sink->format_keys[slot] != NULL) {
+        if (sink->format_keys[slot] == format) {
+            return sink->format_ids[slot];
+        }
+        slot = (slot + 1) % TRACE_FORMAT_SLOTS;
+    }
+    if (sink->n_formats == TRACE_FORMAT_SLOTS - 1) {
+        fprintf(stderr, "Too many distinct trace formats\n");
+        exit(EXIT_FAILURE);
+    }
+    sink->format_keys[slot] = format;
+    sink->format_ids[slot] = sink->n_formats++;
+
+    size_t length = strlen(format);
+    trace_put_varint(sink, TRACE_DEFINE);
+    trace_put_varint(sink, length);
+    trace_write(sink, format, length);
+    return sink->format_ids[slot];
+}
+
+// Write a %s argument as the id of an identical earlier string, or inline, giving it the next id.
+// Strings are matched by content since callers format some of them into reused buffers.
+static void trace_put_string(TraceSink *sink, const char *s) {
+    size_t length = strlen(s);
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)s[i]) * 16777619u;
+    }
+    unsigned slot = hash % TRACE_STRING_SLOTS;
+    while (sink->string_keys[slot] != NULL) {
+        if (strcmp(sink->string_keys[slot], s) == 0) {
+            trace_put_varint(sink, (unsigned long long)sink->string_ids[slot] << 1);
+            return;
+        }
+        slot = (slot + 1) % TRACE_STRING_SLOTS;
+    }
+    trace_put_varint(sink, (unsigned long long)length << 1 | 1);
+    trace_write(sink, s, length);
+    if (sink->n_strings < TRACE_MAX_STRINGS) {
+        sink->string_keys[slot] = (char *)malloc(length + 1);
+        if (sink->string_keys[slot] == NULL) {
+            fprintf(stderr, "Memory allocation failed for trace strings\n");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(sink->string_keys[slot], s, length + 1);
+        sink->string_ids[slot] = sink->n_strings++;
+    }
+}
+
+static void trace_emit_binary(TraceSink *sink, const char *format, const TraceArg *args) {
+    trace_put_varint(sink, TRACE_LINE + trace_format_id(sink, format));
+
+    int timed = trace_is_timed(format);
+    int n = 0;
+    for (const char *f = format; *f != '\0'; ) {
+        if (*f++ != '%') {
+            continue;
+        }
+        int precision, wide;
+        char conversion = trace_conversion(&f, &precision, &wide);
+        const TraceArg *arg = &args[n];
+        if (conversion == 'd') {
+            if (timed && n == 0) {
+                trace_put_varint(sink, trace_zigzag(arg->i - sink->last_time));
+                sink->last_time = arg->i;
+            } else {
+                trace_put_varint(sink, trace_zigzag(arg->i));
+            }
+        } else if (conversion == 'P') {
+            trace_put_varint(sink, (unsigned long long)arg->i);
+        } else if (conversion == 's') {
+            trace_put_string(sink, arg->s);
+        } else if (conversion == 'f') {
+            trace_write(sink, (const char *)&arg->f, sizeof(double));
+        } else {
+            continue;
+        }
+        n++;
+    }
+}
+
+static void trace_emit_int(TraceSink *sink, long long value) {
+    char digits[24];
+    int n = sizeof(digits);
+    unsigned long long magnitude = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[--n] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--n] = '-';
+    }
+    trace_write(sink, digits + n, sizeof(digits) - n);
+}
+
+// Render one trace line as text; shared by the live simulators and the binary log decoder
+void trace_emit_text(TraceSink *sink, const char *format, const TraceArg *args) {
+    const char *literal = format;
+    int n = 0;
+    for (const char *f = format; *f != '\0'; ) {
+        if (*f != '%') {
+            f++;
+            continue;
+        }
+        trace_write(sink, literal, f - literal);
+        f++;
+        int precision, wide;
+        char conversion = trace_conversion(&f, &precision, &wide);
+        const TraceArg *arg = &args[n];
+        if (conversion == 'd') {
+            trace_emit_int(sink, arg->i);
+        } else if (conversion == 'P') {
+            char id[PROCESS_NAME_MAX];
+            trace_write(sink, id, format_process_id((int)arg->i, id));
+        } else if (conversion == 's') {
+            trace_write(sink, arg->s, strlen(arg->s));
+        } else if (conversion == 'f') {
+            char number[64];
+            int length = snprintf(number, sizeof(number), "%.*f", precision < 0 ? 6 : precision, arg->f);
+            trace_write(sink, number, length);
+        } else {
+            trace_write(sink, &conversion, 1);
+            literal = f;
+            continue;
+        }
+        n++;
+        literal = f;
+    }
+    trace_write(sink, literal, strlen(literal));
+}
+
+// printf-style trace line supporting %d, %lld, %s, %.Nf and %P (a Process pointer, printed as its ID)
+void trace_printf(TraceSink *sink, const char *format, ...) {
+    TraceArg args[TRACE_MAX_ARGS];
+    int n = 0;
+    va_list list;
+
+    if (sink->discard) {
+        return;
+    }
+
+    va_start(list, format);
+    for (const char *f = format; *f != '\0' && n < TRACE_MAX_ARGS; ) {
+        if (*f++ != '%') {
+            continue;
+        }
+        int precision, wide;
+        char conversion = trace_conversion(&f, &precision, &wide);
+        if (conversion == 'd') {
+            args[n++].i = wide ? va_arg(list, long long) : va_arg(list, int);
+        } else if (conversion == 'P') {
+            args[n++].i = va_arg(list, const Process *) - sink->base;
+        } else if (conversion == 's') {
+            args[n++].s = va_arg(list, const char *);
+        } else if (conversion == 'f') {
+            args[n++].f = va_arg(list, double);
+        }
+    }
+    va_end(list);
+
+    if (sink->binary) {
+        trace_emit_binary(sink, format, args);
+    } else {
+        trace_emit_text(sink, format, args);
+    }
+}
+
+// Render a ready queue snapshot as "[Q A0 A1]" or "[Q empty]"
+void trace_queue_text(TraceSink *sink, const int *pids, int count) {
+    trace_write(sink, "[Q", 2);
+    if (count == 0) {
+        trace_write(sink, " empty", 6);
+    }
+    for (int i = 0; i < count; i++) {
+        char id[PROCESS_NAME_MAX];
+        int length = format_process_id(pids[i], id);
+        trace_write(sink, " ", 1);
+        trace_write(sink, id, length);
+    }
+    trace_write(sink, "]\n", 2);
+}
+
+// Start a ready queue snapshot; follow with trace_queue_item for each process in order
+void trace_queue_begin(TraceSink *sink) {
+    sink->queue_length = 0;
+}
+
+void trace_queue_item(TraceSink *sink, const Process *process) {
+    if (sink->discard) {
+        return;
+    }
+    if (sink->queue_length == sink->queue_capacity) {
+        sink->queue_capacity = sink->queue_capacity ? 2 * sink->queue_capacity : 64;
+        sink->queue = (int *)realloc(sink->queue, sink->queue_capacity * sizeof(int));
+        sink->last_queue = (int *)realloc(sink->last_queue, sink->queue_capacity * sizeof(int));
+        if (sink->queue == NULL || sink->last_queue == NULL) {
+            fprintf(stderr, "Memory allocation failed for queue snapshot\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    sink->queue[sink->queue_length++] = process - sink->base;
+}
+
+// Index of pid in the last written snapshot, or -1 when it was not queued then
+static int trace_last_position(const TraceSink *sink, int pid, int last_length) {
+    if (pid >= sink->position_capacity) {
+        return -1;
+    }
+    int at = sink->position[pid];
+    return (at >= 0 && at < last_length && sink->last_queue[at] == pid) ? at : -1;
+}
+
+// Finish the snapshot; the binary log only stores it when it differs from the previous one
+void trace_queue_end(TraceSink *sink) {
+    if (sink->discard) {
+        return;
+    }
+    if (!sink->binary) {
+        trace_queue_text(sink, sink->queue, sink->queue_length);
+        return;
+    }
+
+    if (sink->queue_length == sink->last_queue_length &&
+        (sink->queue_length == 0 || memcmp(sink->queue, sink->last_queue, sink->queue_length * sizeof(int)) == 0)) {
+        trace_put_varint(sink, TRACE_QUEUE_SAME);
+        return;
+    }
+    // Between snapshots processes leave and join anywhere in the queue while the rest keep their
+    // order, so store the new snapshot as runs copied from the last one and runs of new entries
+    const int *queue = sink->queue;
+    int length = sink->queue_length;
+    int last_length = sink->last_queue_length < 0 ? 0 : sink->last_queue_length;
+    trace_put_varint(sink, TRACE_QUEUE);
+    trace_put_varint(sink, length);
+    int copied_end = 0;
+    for (int i = 0; i < length; ) {
+        int from = trace_last_position(sink, queue[i], last_length);
+        int count = 1;
+        if (from >= 0) {
+            while (i + count < length && from + count < last_length && queue[i + count] == sink->last_queue[from + count]) {
+                count++;
+            }
+            trace_put_varint(sink, (unsigned long long)count << 1 | 1);
+            trace_put_varint(sink, trace_zigzag(from - copied_end));
+            copied_end = from + count;
+        } else {
+            while (i + count < length && trace_last_position(sink, queue[i + count], last_length) < 0) {
+                count++;
+            }
+            trace_put_varint(sink, (unsigned long long)count << 1);
+            for (int k = i; k < i + count; k++) {
+                trace_put_varint(sink, queue[k]);
+            }
+        }
+        i += count;
+    }
+
+    int *swap = sink->last_queue;
+    sink->last_queue = sink->queue;
+    sink->queue = swap;
+    sink->last_queue_length = length;
+    for (int i = 0; i < length; i++) {
+        int pid = sink->last_queue[i];
+        if (pid >= sink->position_capacity) {
+            int capacity = sink->position_capacity ? sink->position_capacity : 64;
+            while (capacity <= pid) {
+                capacity *= 2;
+            }
+            sink->position = (int *)realloc(sink->position, capacity * sizeof(int));
+            if (sink->position == NULL) {
+                fprintf(stderr, "Memory allocation failed for queue snapshot\n");
+                exit(EXIT_FAILURE);
+            }
+            for (int k = sink->position_capacity; k < capacity; k++) {
+                sink->position[k] = -1;
+            }
+            sink->position_capacity = capacity;
+        }
+        sink->position[pid] = i;
+    }
+}
+
+#endif // TRACE_H
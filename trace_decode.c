@@ -0,0 +1,241 @@
+// Offline decoder for the binary event log written by --binary-trace.
+// Regenerates exactly the text trace the simulators would have printed.
+//
+// Build: gcc -O2 -o trace_decode trace_decode.c
+// Usage: ./trace_decode trace.bin > trace.txt
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+// Cursor over the memory-mapped event log
+typedef struct {
+    const unsigned char *data;
+    size_t length;
+    size_t pos;
+} TraceReader;
+
+// %s arguments the log has given ids to, in id order
+typedef struct {
+    char *strings[TRACE_MAX_STRINGS];
+    int count;
+} StringTable;
+
+
+void truncatedTrace(void) {
+    trace_flush(&trace_stdout);
+    fprintf(stderr, "Binary trace is truncated or corrupt\n");
+    exit(EXIT_FAILURE);
+}
+
+
+unsigned long long read_varint(TraceReader *reader) {
+    unsigned long long value = 0;
+    int shift = 0;
+    while (1) {
+        if (reader->pos >= reader->length || shift > 63) {
+            truncatedTrace();
+        }
+        unsigned char byte = reader->data[reader->pos++];
+        value |= (unsigned long long)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+        shift += 7;
+    }
+}
+
+
+long long read_zigzag(TraceReader *reader) {
+    unsigned long long value = read_varint(reader);
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+
+const unsigned char* read_bytes(TraceReader *reader, size_t length) {
+    if (length > reader->length - reader->pos) {
+        truncatedTrace();
+    }
+    const unsigned char *bytes = reader->data + reader->pos;
+    reader->pos += length;
+    return bytes;
+}
+
+
+// Decode the arguments of one line record and print it through the shared text formatter
+void decode_line(TraceReader *reader, const char *format, long long *last_time, StringTable *table) {
+    TraceArg args[TRACE_MAX_ARGS] = { { 0 } };
+    char *strings[TRACE_MAX_ARGS];
+    int n_strings = 0;
+    int timed = trace_is_timed(format);
+    int n = 0;
+
+    for (const char *f = format; *f != '\0' && n < TRACE_MAX_ARGS; ) {
+        if (*f++ != '%') {
+            continue;
+        }
+        int precision, wide;
+        char conversion = trace_conversion(&f, &precision, &wide);
+        if (conversion == 'd') {
+            args[n].i = read_zigzag(reader);
+            if (timed && n == 0) {
+                args[n].i += *last_time;
+                *last_time = args[n].i;
+            }
+        } else if (conversion == 'P') {
+            args[n].i = (long long)read_varint(reader);
+        } else if (conversion == 's') {
+            unsigned long long value = read_varint(reader);
+            if (!(value & 1)) {
+                if (value >> 1 >= (unsigned long long)table->count) {
+                    truncatedTrace();
+                }
+                args[n++].s = table->strings[value >> 1];
+                continue;
+            }
+            size_t length = value >> 1;
+            const unsigned char *bytes = read_bytes(reader, length);
+            char *copy = (char *)malloc(length + 1);
+            if (copy == NULL) {
+                fprintf(stderr, "Memory allocation failed for trace string\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(copy, bytes, length);
+            copy[length] = '\0';
+            if (table->count < TRACE_MAX_STRINGS) {
+                table->strings[table->count++] = copy;
+            } else {
+                strings[n_strings++] = copy;
+            }
+            args[n].s = copy;
+        } else if (conversion == 'f') {
+            memcpy(&args[n].f, read_bytes(reader, sizeof(double)), sizeof(double));
+        } else {
+            continue;
+        }
+        n++;
+    }
+
+    trace_emit_text(&trace_stdout, format, args);
+    for (int i = 0; i < n_strings; i++) {
+        free(strings[i]);
+    }
+}
+
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Expected Input: ./%s trace.bin\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        fprintf(stderr, "Unable to open binary trace file %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    TraceReader reader = { NULL, (size_t)info.st_size, 0 };
+    if (reader.length > 0) {
+        reader.data = mmap(NULL, reader.length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (reader.data == MAP_FAILED) {
+            fprintf(stderr, "Unable to map binary trace file %s\n", argv[1]);
+            exit(EXIT_FAILURE);
+        }
+        madvise((void *)reader.data, reader.length, MADV_SEQUENTIAL);
+    }
+
+    size_t magic_length = strlen(TRACE_MAGIC);
+    if (reader.length < magic_length + 1 || memcmp(reader.data, TRACE_MAGIC, magic_length) != 0) {
+        fprintf(stderr, "%s is not a binary simulator trace\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    if (reader.data[magic_length] != TRACE_VERSION) {
+        fprintf(stderr, "Unsupported binary trace version %d\n", reader.data[magic_length]);
+        exit(EXIT_FAILURE);
+    }
+    reader.pos = magic_length + 1;
+
+    char **formats = NULL;
+    int n_formats = 0;
+    int formats_capacity = 0;
+    int *queue = NULL;
+    int *next_queue = NULL;
+    int queue_length = 0;
+    long long last_time = 0;
+    StringTable strings = { { NULL }, 0 };
+
+    while (reader.pos < reader.length) {
+        unsigned long long code = read_varint(&reader);
+        if (code == TRACE_DEFINE) {
+            size_t length = read_varint(&reader);
+            const unsigned char *bytes = read_bytes(&reader, length);
+            if (n_formats == formats_capacity) {
+                formats_capacity = formats_capacity ? 2 * formats_capacity : 64;
+                formats = (char **)realloc(formats, formats_capacity * sizeof(char *));
+            }
+            char *format = (char *)malloc(length + 1);
+            if (formats == NULL || format == NULL) {
+                fprintf(stderr, "Memory allocation failed for trace formats\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(format, bytes, length);
+            format[length] = '\0';
+            formats[n_formats++] = format;
+        } else if (code == TRACE_QUEUE_SAME) {
+            trace_queue_text(&trace_stdout, queue, queue_length);
+        } else if (code == TRACE_QUEUE) {
+            // Rebuild the snapshot from runs copied out of the previous one and runs of new entries
+            unsigned long long length = read_varint(&reader);
+            if (length > (unsigned long long)queue_length + reader.length) {
+                truncatedTrace();
+            }
+            next_queue = (int *)realloc(next_queue, (length + 1) * sizeof(int));
+            if (next_queue == NULL) {
+                fprintf(stderr, "Memory allocation failed for queue snapshot\n");
+                exit(EXIT_FAILURE);
+            }
+            unsigned long long filled = 0;
+            long long copied_end = 0;
+            while (filled < length) {
+                unsigned long long run = read_varint(&reader);
+                unsigned long long count = run >> 1;
+                if (count == 0 || count > length - filled) {
+                    truncatedTrace();
+                }
+                if (run & 1) {
+                    long long from = copied_end + read_zigzag(&reader);
+                    if (from < 0 || from > queue_length || count > (unsigned long long)(queue_length - from)) {
+                        truncatedTrace();
+                    }
+                    memcpy(next_queue + filled, queue + from, count * sizeof(int));
+                    copied_end = from + (long long)count;
+                } else {
+                    for (unsigned long long i = 0; i < count; i++) {
+                        next_queue[filled + i] = (int)read_varint(&reader);
+                    }
+                }
+                filled += count;
+            }
+
+            int *swap = queue;
+            queue = next_queue;
+            next_queue = swap;
+            queue_length = (int)length;
+            trace_queue_text(&trace_stdout, queue, queue_length);
+        } else if (code - TRACE_LINE < (unsigned long long)n_formats) {
+            decode_line(&reader, formats[code - TRACE_LINE], &last_time, &strings);
+        } else {
+            truncatedTrace();
+        }
+    }
+
+    trace_flush(&trace_stdout);
+    return 0;
+}
@@ -0,0 +1,275 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+#include "process.h"
+#include "rand48.h"
+
+// Smallest number of processes worth handing to a generator thread
+#define WORKLOAD_CHUNK_MIN 8192
+// Relative distance from the exponential cutoff below which draws are tested with the exact formula
+#define WORKLOAD_GUARD_BAND 1e-9
+
+double next_exp(Rand48 *rng, double lambda, double upper_bound) {
+    while (1) {
+        double r = rand48_next(rng);
+        double x = -log(r) / lambda;
+        if (x <= upper_bound) {
+            return x;
+        }
+    }
+}
+
+
+// One CPU burst; CPU-bound processes run four times longer
+int draw_cpu_burst(Rand48 *rng, double lambda, double upper_bound, int is_cpu_bound) {
+    return (int)ceil(next_exp(rng, lambda, upper_bound)) * (is_cpu_bound ? 4 : 1);
+}
+
+// One I/O burst; I/O-bound processes block eight times longer
+int draw_io_burst(Rand48 *rng, double lambda, double upper_bound, int is_cpu_bound) {
+    return (int)ceil(next_exp(rng, lambda, upper_bound)) * 8 / (is_cpu_bound ? 8: 1);
+}
+
+
+// Function to generate a processes data, storing its bursts in the given slots of the burst tables
+void generate_process(Process *process, Rand48 *rng, double lambda, double upper_bound, int is_cpu_bound, int *cpu_bursts, int *io_bursts) {
+    // Generate arrival time
+    process->is_cpu_bound = is_cpu_bound;
+    process->arrival_time = (int)floor(next_exp(rng, lambda, upper_bound));
+
+    // Generate number of CPU bursts (1 to 32)
+    process->num_bursts = (int)ceil(rand48_next(rng) * 32);
+
+    // Generate CPU and I/O burst times
+    for (int i = 0; i < process->num_bursts; i++) {
+        cpu_bursts[i] = draw_cpu_burst(rng, lambda, upper_bound, is_cpu_bound);
+        if (i < process->num_bursts - 1) {
+            io_bursts[i] = draw_io_burst(rng, lambda, upper_bound, is_cpu_bound);
+        }
+    }
+}
+
+
+// Argument constraints shared by single runs and sweep points
+int valid_parameters(int n_processes, int n_cpu_processes, int seed, double lambda, int ceiling, int tcs, double alpha, int t_slice) {
+    return !(n_processes <= 0 || n_cpu_processes < 0 || n_cpu_processes > n_processes || seed < 0 ||
+             lambda <= 0 || ceiling <= 0 || tcs <= 0 || tcs % 2 != 0 ||
+             alpha < -1 || alpha > 1 || t_slice <= 0);
+}
+
+
+// Whether next_exp keeps draw r. Equivalent to -log(r) / lambda <= upper_bound, but away from
+// the cutoff a comparison against threshold = exp(-lambda * upper_bound) decides it without a log
+static int exp_draw_accepted(double r, double threshold, double lambda, double upper_bound) {
+    if (r > threshold * (1 + WORKLOAD_GUARD_BAND)) {
+        return 1;
+    }
+    if (r < threshold * (1 - WORKLOAD_GUARD_BAND)) {
+        return 0;
+    }
+    return -log(r) / lambda <= upper_bound;
+}
+
+static uint64_t count_exp_draws(Rand48 *rng, double threshold, double lambda, double upper_bound) {
+    uint64_t draws = 1;
+    while (!exp_draw_accepted(rand48_next(rng), threshold, lambda, upper_bound)) {
+        draws++;
+    }
+    return draws;
+}
+
+// Number of draws generate_process takes, consuming them from rng, and the number of CPU bursts it draws
+static uint64_t count_process_draws(Rand48 *rng, double threshold, double lambda, double upper_bound, int *num_bursts_out) {
+    uint64_t draws = count_exp_draws(rng, threshold, lambda, upper_bound) + 1;
+    int num_bursts = (int)ceil(rand48_next(rng) * 32);
+    *num_bursts_out = num_bursts;
+    for (int i = 0; i < num_bursts; i++) {
+        draws += count_exp_draws(rng, threshold, lambda, upper_bound);
+        if (i < num_bursts - 1) {
+            draws += count_exp_draws(rng, threshold, lambda, upper_bound);
+        }
+    }
+    return draws;
+}
+
+
+// Processes [begin, end) generated by one thread from its own stream
+typedef struct {
+    pthread_t thread;
+    ProcessSet *set;
+    int begin;
+    int end;
+    int n_cpu_processes;
+    double lambda;
+    double upper_bound;
+    Rand48 rng;             // Positioned at the first draw of process begin
+    int burst_offset;       // Index of process begin's first CPU burst, from the sizing pass
+    int burst_end;          // Where this chunk's bursts actually ended
+    StatAccumulator cpu_burst_stats[2];     // This chunk's share of the set's burst statistics
+    StatAccumulator io_burst_stats[2];
+} WorkloadChunk;
+
+static void* generate_chunk(void *arg) {
+    WorkloadChunk *chunk = (WorkloadChunk *)arg;
+    ProcessSet *set = chunk->set;
+    int offset = chunk->burst_offset;
+    for (int i = chunk->begin; i < chunk->end; i++) {
+        Process *process = &set->processes[i];
+        process->id = i;
+        generate_process(process, &chunk->rng, chunk->lambda, chunk->upper_bound, (i < chunk->n_cpu_processes ? 1 : 0),
+                         set->cpu_bursts + offset, set->io_bursts + (offset - i));
+        set->columns.arrival_time[i] = process->arrival_time;
+        set->columns.num_bursts[i] = process->num_bursts;
+        set->columns.burst_offset[i] = offset;
+        set->columns.is_cpu_bound[i] = (unsigned char)process->is_cpu_bound;
+        for (int b = 0; b < process->num_bursts; b++) {
+            stat_add(&chunk->cpu_burst_stats[process->is_cpu_bound], set->cpu_bursts[offset + b]);
+            if (b < process->num_bursts - 1) {
+                stat_add(&chunk->io_burst_stats[process->is_cpu_bound], set->io_bursts[offset - i + b]);
+            }
+        }
+        offset += process->num_bursts;
+    }
+    chunk->burst_end = offset;
+    return NULL;
+}
+
+
+// Build the full process set for one parameter point. The processes are identical to drawing
+// them one after another from srand48(seed). A cheap counting pass sizes the burst tables so the
+// whole set is one allocation; it also finds where each chunk starts in the stream, so with
+// jobs > 1 and enough processes the chunks are generated on separate threads, each skipping its
+// generator ahead to its own offset.
+ProcessSet generate_workload(int n_processes, int n_cpu_processes, int seed, double lambda, int ceiling, int jobs) {
+    if (jobs > n_processes / WORKLOAD_CHUNK_MIN) {
+        jobs = n_processes / WORKLOAD_CHUNK_MIN;
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    }
+
+    WorkloadChunk *chunks = (WorkloadChunk *)malloc(jobs * sizeof(WorkloadChunk));
+    if (chunks == NULL) {
+        fprintf(stderr, "Memory allocation failed for workload chunks\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double threshold = exp(-lambda * ceiling);
+    Rand48 counter;
+    rand48_seed(&counter, seed);
+    uint64_t offset = 0;
+    long long n_bursts = 0;
+    for (int c = 0; c < jobs; c++) {
+        WorkloadChunk *chunk = &chunks[c];
+        chunk->begin = (int)((long long)n_processes * c / jobs);
+        chunk->end = (int)((long long)n_processes * (c + 1) / jobs);
+        chunk->n_cpu_processes = n_cpu_processes;
+        chunk->lambda = lambda;
+        chunk->upper_bound = ceiling;
+        chunk->burst_offset = (int)n_bursts;
+        memset(chunk->cpu_burst_stats, 0, sizeof(chunk->cpu_burst_stats));
+        memset(chunk->io_burst_stats, 0, sizeof(chunk->io_burst_stats));
+        rand48_seed(&chunk->rng, seed);
+        rand48_skip(&chunk->rng, offset);
+        for (int i = chunk->begin; i < chunk->end; i++) {
+            int num_bursts;
+            offset += count_process_draws(&counter, threshold, lambda, ceiling, &num_bursts);
+            n_bursts += num_bursts;
+        }
+        if (n_bursts > INT_MAX) {
+            fprintf(stderr, "Too many CPU bursts for one process set\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ProcessSet set = allocate_process_set(n_processes, (int)n_bursts, BURSTS_STORED);
+    set.lambda = lambda;
+    set.upper_bound = ceiling;
+    for (int c = 0; c < jobs; c++) {
+        chunks[c].set = &set;
+    }
+    if (jobs == 1) {
+        generate_chunk(&chunks[0]);
+    } else {
+        for (int c = 0; c < jobs; c++) {
+            if (pthread_create(&chunks[c].thread, NULL, generate_chunk, &chunks[c]) != 0) {
+                fprintf(stderr, "Unable to start workload generator thread\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        for (int c = 0; c < jobs; c++) {
+            pthread_join(chunks[c].thread, NULL);
+        }
+    }
+
+    // The counting pass and the generator must have agreed on every burst count
+    for (int c = 0; c < jobs; c++) {
+        int expected = (c == jobs - 1) ? set.n_bursts : chunks[c + 1].burst_offset;
+        if (chunks[c].burst_end != expected) {
+            fprintf(stderr, "Workload generation disagreed with its sizing pass\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int bound = 0; bound < 2; bound++) {
+            stat_merge(&set.cpu_burst_stats[bound], &chunks[c].cpu_burst_stats[bound]);
+            stat_merge(&set.io_burst_stats[bound], &chunks[c].io_burst_stats[bound]);
+        }
+    }
+
+    free(chunks);
+    build_arrival_order(&set);
+    return set;
+}
+
+
+// Build a process set whose bursts are drawn on demand by a BurstCursor. Each process keeps its
+// generator positioned at its first CPU burst; its bursts are only counted past, as the sizing
+// pass of generate_workload does, so the next process starts exactly where it would on the eager
+// path. The set's burst statistics stay empty until a cursor collecting them has consumed every burst.
+ProcessSet generate_streaming_workload(int n_processes, int n_cpu_processes, int seed, double lambda, int ceiling) {
+    ProcessSet set = allocate_process_set(n_processes, 0, BURSTS_GENERATED);
+    set.lambda = lambda;
+    set.upper_bound = ceiling;
+
+    double threshold = exp(-lambda * ceiling);
+    Rand48 rng;
+    rand48_seed(&rng, seed);
+    long long n_bursts = 0;
+    for (int i = 0; i < n_processes; i++) {
+        Process *process = &set.processes[i];
+        process->id = i;
+        process->is_cpu_bound = (i < n_cpu_processes ? 1 : 0);
+        process->arrival_time = (int)floor(next_exp(&rng, lambda, ceiling));
+        process->num_bursts = (int)ceil(rand48_next(&rng) * 32);
+
+        set.columns.arrival_time[i] = process->arrival_time;
+        set.columns.num_bursts[i] = process->num_bursts;
+        set.columns.burst_offset[i] = (int)n_bursts;
+        set.columns.is_cpu_bound[i] = (unsigned char)process->is_cpu_bound;
+        set.columns.burst_rng[i] = rng;
+
+        for (int b = 0; b < process->num_bursts; b++) {
+            count_exp_draws(&rng, threshold, lambda, ceiling);
+            if (b < process->num_bursts - 1) {
+                count_exp_draws(&rng, threshold, lambda, ceiling);
+            }
+        }
+        n_bursts += process->num_bursts;
+        if (n_bursts > INT_MAX) {
+            fprintf(stderr, "Too many CPU bursts for one process set\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    set.n_bursts = (int)n_bursts;
+
+    build_arrival_order(&set);
+    return set;
+}
+
+#endif // WORKLOAD_H